@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef NDEF_ASYNC_H
+#define NDEF_ASYNC_H
+
+#include "ndef_rec.h"
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Asynchronous versions of the parsing and constructor functions for
+ * GMainLoop based applications. The work is done by a GTask on a worker
+ * thread, the callback is invoked on the thread-default main context
+ * of the thread which has made the call. The input is copied, it doesn't
+ * have to stay around until the operation completes.
+ *
+ * Cancelling the operation completes it immediately with G_IO_ERROR_CANCELLED
+ * (the work itself can't be interrupted, its result is discarded). The
+ * functions which would return NULL complete with G_IO_ERROR_INVALID_DATA
+ * (parsing) or G_IO_ERROR_INVALID_ARGUMENT (constructors). The _finish
+ * functions return a new reference.
+ *
+ * This header pulls in GIO and therefore isn't included by nfcdef.h,
+ * it has to be included explicitly.
+ */
+
+void
+ndef_rec_new_async(
+    const GUtilData* block,
+    GCancellable* cancel,
+    GAsyncReadyCallback callback,
+    gpointer user_data);
+
+NdefRec*
+ndef_rec_new_finish(
+    GAsyncResult* result,
+    GError** error);
+
+void
+ndef_rec_new_from_tlv_async(
+    const GUtilData* tlv,
+    GCancellable* cancel,
+    GAsyncReadyCallback callback,
+    gpointer user_data);
+
+NdefRec*
+ndef_rec_new_from_tlv_finish(
+    GAsyncResult* result,
+    GError** error);
+
+void
+ndef_rec_u_new_async(
+    const char* uri,
+    GCancellable* cancel,
+    GAsyncReadyCallback callback,
+    gpointer user_data);
+
+NdefRecU*
+ndef_rec_u_new_finish(
+    GAsyncResult* result,
+    GError** error);
+
+void
+ndef_rec_t_new_async(
+    const char* text,
+    const char* lang,
+    NDEF_REC_T_ENC enc,
+    GCancellable* cancel,
+    GAsyncReadyCallback callback,
+    gpointer user_data);
+
+NdefRecT*
+ndef_rec_t_new_finish(
+    GAsyncResult* result,
+    GError** error);
+
+void
+ndef_rec_sp_new_async(
+    const char* uri,
+    const char* title,
+    const char* lang,
+    const char* type,
+    guint size,
+    NDEF_SP_ACT act,
+    const NdefMedia* icon,
+    GCancellable* cancel,
+    GAsyncReadyCallback callback,
+    gpointer user_data);
+
+NdefRecSp*
+ndef_rec_sp_new_finish(
+    GAsyncResult* result,
+    GError** error);
+
+G_END_DECLS
+
+#endif /* NDEF_ASYNC_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef NDEF_MSG_H
+#define NDEF_MSG_H
+
+#include "ndef_types.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Allocation-free iterator over the records of an NDEF message. The
+ * records are returned as views into the caller's buffer, which must
+ * stay alive while the iterator and the returned data are being used.
+ * Chunked records are returned as is, it's up to the caller to deal
+ * with them. Usage:
+ *
+ * NdefMsgIter it;
+ * NdefMsgRec rec;
+ *
+ * ndef_msg_iter_init(&it, &msg);
+ * while (ndef_msg_iter_next(&it, &rec)) {
+ *   ... analyze rec
+ * }
+ * if (it.data.size) {
+ *   ... garbage at it.offset
+ * }
+ */
+
+/* Record header flags */
+#define NDEF_HDR_MB       (0x80)
+#define NDEF_HDR_ME       (0x40)
+#define NDEF_HDR_CF       (0x20)
+#define NDEF_HDR_SR       (0x10)
+#define NDEF_HDR_IL       (0x08)
+#define NDEF_HDR_TNF_MASK (0x07)
+
+typedef struct ndef_msg_rec {
+    guint8 hdr;             /* NDEF_HDR_* flags and TNF */
+    NDEF_TNF tnf;
+    GUtilData raw;
+    GUtilData type;
+    GUtilData id;
+    GUtilData payload;
+} NdefMsgRec;
+
+typedef struct ndef_msg_iter {
+    GUtilData data;         /* Unparsed part of the message */
+    gsize offset;           /* Offset of the data within the message */
+} NdefMsgIter;
+
+void
+ndef_msg_iter_init(
+    NdefMsgIter* iter,
+    const GUtilData* msg);
+
+gboolean
+ndef_msg_iter_next(
+    NdefMsgIter* iter,
+    NdefMsgRec* rec);
+
+/*
+ * Record index. ndef_msg_index_new() makes a single header-only pass
+ * over the message and remembers where each record is. Any record can
+ * then be decoded on demand with ndef_msg_index_get() (or passed to
+ * ndef_rec_new() as rec.raw) without touching the preceding ones. The
+ * message buffer isn't referenced by the index, the same buffer has to
+ * be passed to ndef_msg_index_get().
+ *
+ * The whole index is allocated as a single memory block, free it with
+ * g_free(). NULL is returned if there are no records in the message.
+ */
+typedef struct ndef_msg_index_entry {
+    guint32 offset;
+    guint32 size;
+} NdefMsgIndexEntry;
+
+typedef struct ndef_msg_index {
+    guint count;
+    const NdefMsgIndexEntry* entry;
+} NdefMsgIndex;
+
+NdefMsgIndex*
+ndef_msg_index_new(
+    const GUtilData* msg);
+
+gboolean
+ndef_msg_index_get(
+    const NdefMsgIndex* index,
+    const GUtilData* msg,
+    guint i,
+    NdefMsgRec* rec);
+
+/*
+ * Packed copy of a record, for keeping lots of records around. It's
+ * a single memory block holding the raw record preceded by a small
+ * header with the offsets of the type and the payload, i.e. about 8
+ * bytes of overhead per record compared to well over a hundred bytes
+ * for NdefRec. ndef_msg_rec_pack() copies just the record at the
+ * beginning of the raw data (e.g. NdefRec.raw or NdefMsgRec.raw) and
+ * returns NULL if it's not a valid record. ndef_msg_rec_unpack() fills
+ * NdefMsgRec with views into the packed copy, without allocating
+ * anything. Free the copy with g_free().
+ */
+typedef struct ndef_msg_rec_pack NdefMsgRecPack;
+
+NdefMsgRecPack*
+ndef_msg_rec_pack(
+    const GUtilData* raw);
+
+gboolean
+ndef_msg_rec_unpack(
+    const NdefMsgRecPack* pack,
+    NdefMsgRec* rec);
+
+/*
+ * ndef_msg_check() validates the structure of the message without
+ * allocating anything: MB/ME framing, length arithmetic, chunking
+ * rules and TNF constraints on the type, id and payload lengths.
+ * Returns the actual size of the message including the ME record,
+ * zero if the message is broken or incomplete. In the latter case,
+ * error_offset (if not NULL) receives the offset of the first record
+ * which failed the check (or the size of the input if ME is missing).
+ */
+gsize
+ndef_msg_check(
+    const GUtilData* msg,
+    gsize* error_offset);
+
+/*
+ * Visitor API. ndef_msg_visit() walks the message (and the content of
+ * Smart Posters) and invokes the callbacks with decoded but not yet
+ * converted data, as views into the message buffer. Nothing is
+ * allocated unless the callback asks ndef_msg_decode_*() for a string.
+ *
+ * Smart Poster content is reported between sp_start and sp_end, in the
+ * order in which it occurs in the message. Unlike NdefRecSp, it's not
+ * checked for duplicates. Smart Posters nested in Smart Posters are
+ * reported as other records. So are the well-known records which fail
+ * to decode, and chunked records.
+ *
+ * Any callback can be NULL. Returning FALSE from a callback stops the
+ * walk. ndef_msg_visit() returns TRUE if the whole message has been
+ * visited, FALSE if it has been stopped or there's garbage at the end.
+ */
+typedef struct ndef_msg_visitor {
+    gboolean (*uri)(const NdefMsgRec* rec, const GUtilData* prefix,
+        const GUtilData* suffix, gpointer user_data);
+    gboolean (*text)(const NdefMsgRec* rec, const GUtilData* lang,
+        const GUtilData* text, NDEF_REC_T_ENC enc, gpointer user_data);
+    gboolean (*sp_start)(const NdefMsgRec* rec, gpointer user_data);
+    gboolean (*sp_act)(const NdefMsgRec* rec, NDEF_SP_ACT act,
+        gpointer user_data);
+    gboolean (*sp_size)(const NdefMsgRec* rec, guint size,
+        gpointer user_data);
+    gboolean (*sp_type)(const NdefMsgRec* rec, const GUtilData* type,
+        gpointer user_data);
+    gboolean (*sp_icon)(const NdefMsgRec* rec, const GUtilData* type,
+        const GUtilData* data, gpointer user_data);
+    gboolean (*sp_end)(const NdefMsgRec* rec, gpointer user_data);
+    gboolean (*other)(const NdefMsgRec* rec, gpointer user_data);
+} NdefMsgVisitor;
+
+gboolean
+ndef_msg_visit(
+    const GUtilData* msg,
+    const NdefMsgVisitor* visitor,
+    gpointer user_data);
+
+/*
+ * ndef_msg_rec_encode() builds a single record. The header byte is a
+ * combination of NDEF_HDR_MB, NDEF_HDR_ME and NDEF_HDR_CF flags and
+ * the TNF, the SR and IL flags are set automatically. Any of type, id
+ * and payload can be NULL. Returns NULL if something doesn't fit.
+ */
+GBytes*
+ndef_msg_rec_encode(
+    guint8 hdr,
+    const GUtilData* type,
+    const GUtilData* id,
+    const GUtilData* payload);
+
+/* These allocate a string, caller must g_free() it */
+
+char*
+ndef_msg_decode_uri(
+    const GUtilData* prefix,
+    const GUtilData* suffix);
+
+char*
+ndef_msg_decode_text(
+    const GUtilData* text,
+    NDEF_REC_T_ENC enc); /* NULL if text is invalid */
+
+G_END_DECLS
+
+#endif /* NDEF_MSG_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef NDEF_PIPELINE_H
+#define NDEF_PIPELINE_H
+
+#include "ndef_rec.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Ordered parsing of a stream of inputs (e.g. raw tag images coming
+ * from a reader) on a number of worker threads.
+ *
+ * ndef_pipeline_submit() copies the input into a bounded queue and
+ * returns its sequence number (starting with zero). If the queue is
+ * full, the call blocks until the oldest input has been delivered,
+ * which slows the producer down when the consumer can't keep up.
+ *
+ * The callback receives the results strictly in submission order. It's
+ * invoked on one of the worker threads, one call at a time. The record
+ * is NULL if the input couldn't be parsed, otherwise it's valid for the
+ * duration of the call (the callback has to add a reference to keep it).
+ *
+ * ndef_pipeline_free() waits until all submitted inputs have been
+ * delivered and then stops the threads. The pipeline must not be freed
+ * from the callback.
+ */
+
+typedef struct ndef_pipeline NdefPipeline;
+
+typedef
+void
+(*NdefPipelineFunc)(
+    guint64 seq,
+    NdefRec* rec,
+    gpointer user_data);
+
+typedef struct ndef_pipeline_stats {
+    guint64 submitted;
+    guint64 delivered;
+    guint64 failed;         /* Delivered as NULL */
+    guint64 blocked;        /* Number of times the producer had to wait */
+    guint queued;           /* Submitted but not yet delivered */
+    guint max_queued;       /* High watermark of the above */
+    gint64 parse_us;        /* Total time spent in the parser */
+    gint64 elapsed_us;      /* Since the pipeline has been created */
+} NdefPipelineStats;
+
+NdefPipeline*
+ndef_pipeline_new(
+    guint threads,          /* Zero means one per CPU */
+    guint capacity,         /* Zero means twice the number of threads */
+    gboolean tlv,           /* TLV sequences rather than NDEF messages */
+    const NdefParseOpt* opt,
+    NdefPipelineFunc func,
+    gpointer user_data);
+
+guint64
+ndef_pipeline_submit(
+    NdefPipeline* pipe,
+    const GUtilData* data);
+
+void
+ndef_pipeline_get_stats(
+    NdefPipeline* pipe,
+    NdefPipelineStats* stats);
+
+void
+ndef_pipeline_free(
+    NdefPipeline* pipe);
+
+G_END_DECLS
+
+#endif /* NDEF_PIPELINE_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -41,6 +41,7 @@
 #define NDEF_REC_H
 
 #include "ndef_types.h"
+#include "ndef_util.h"
 
 #include <glib-object.h>
 
@@ -60,17 +61,6 @@ typedef enum nfc_ndef_rtd {
     NDEF_RTD_SMART_POSTER           /* "Sp" */
 } NDEF_RTD;
 
-/* TNF = Type name format */
-typedef enum nfc_ndef_tnf {
-    NDEF_TNF_EMPTY,
-    NDEF_TNF_WELL_KNOWN,
-    NDEF_TNF_MEDIA_TYPE,
-    NDEF_TNF_ABSOLUTE_URI,
-    NDEF_TNF_EXTERNAL
-} NDEF_TNF;
-
-#define NDEF_TNF_MAX NDEF_TNF_EXTERNAL
-
 typedef struct nfc_ndef_rec_priv NdefRecPriv;
 
 struct nfc_ndef_rec {
@@ -104,6 +94,204 @@ ndef_rec_new_mediatype(
     const GUtilData* type,
     const GUtilData* payload);
 
+/*
+ * Same as ndef_rec_new_mediatype() but takes ownership of the payload,
+ * which is released before the function returns. The record is one
+ * contiguous buffer (see the raw field), so the payload is copied into
+ * it, but only once and without any intermediate buffers.
+ */
+NdefRec*
+ndef_rec_new_mediatype_take(
+    const GUtilData* type,
+    GBytes* payload);
+
+/*
+ * Resource-bounded parsing. Zero means no limit. The depth of the
+ * top-level message is 1, SmartPoster content is one level deeper.
+ * The byte count is an estimate of the memory allocated by the parser.
+ * If any limit is hit, parsing stops and NULL is returned.
+ *
+ * With NDEF_PARSE_FLAG_PACKED, the records of a parsed message (and
+ * their decoded data) share a few large memory blocks instead of each
+ * having its own buffer. That's fewer allocations, but a block is only
+ * freed when the last record stored in it is gone, so keeping a single
+ * record keeps the whole message in memory. Packed records don't reuse
+ * the buffers of the pooled ones either (see ndef_rec_pool_set_max_size).
+ */
+typedef enum nfc_ndef_parse_flags {
+    NDEF_PARSE_FLAGS_NONE = 0x00,
+    NDEF_PARSE_FLAG_PACKED = 0x01
+} NDEF_PARSE_FLAGS;
+
+typedef struct nfc_ndef_parse_opt {
+    guint max_records;
+    gsize max_bytes;
+    guint max_depth;
+    guint max_time_ms;
+    NDEF_PARSE_FLAGS flags;
+} NdefParseOpt;
+
+typedef enum nfc_ndef_parse_result {
+    NDEF_PARSE_OK,
+    NDEF_PARSE_ERROR,               /* Nothing could be parsed */
+    NDEF_PARSE_LIMIT_RECORDS,
+    NDEF_PARSE_LIMIT_BYTES,
+    NDEF_PARSE_LIMIT_DEPTH,
+    NDEF_PARSE_LIMIT_TIME
+} NDEF_PARSE_RESULT;
+
+NdefRec*
+ndef_rec_new_opt(
+    const GUtilData* block,
+    const NdefParseOpt* opt,
+    NDEF_PARSE_RESULT* result);
+
+NdefRec*
+ndef_rec_new_from_tlv_opt(
+    const GUtilData* tlv,
+    const NdefParseOpt* opt,
+    NDEF_PARSE_RESULT* result);
+
+/*
+ * Parser context. Keeps the options and the memory which can be reused
+ * between calls (e.g. UTF-16 converters and buffers). Returns the same
+ * results as ndef_rec_new_opt() and ndef_rec_new_from_tlv_opt() would.
+ * A parser can only be used by one thread at a time, each worker thread
+ * needs its own one.
+ */
+typedef struct ndef_parser NdefParser;
+
+NdefParser*
+ndef_parser_new(
+    const NdefParseOpt* opt);
+
+void
+ndef_parser_free(
+    NdefParser* parser);
+
+NdefRec*
+ndef_parser_parse(
+    NdefParser* parser,
+    const GUtilData* block,
+    NDEF_PARSE_RESULT* result);
+
+NdefRec*
+ndef_parser_parse_tlv(
+    NdefParser* parser,
+    const GUtilData* tlv,
+    NDEF_PARSE_RESULT* result);
+
+/*
+ * Filtered parsing. Only the top-level records matching all non-zero
+ * criteria become NdefRec objects, the rest are skipped as soon as
+ * their header is decoded. Parsing stops after max_matches records
+ * have been found.
+ *
+ * tnf_mask is a combination of NDEF_TNF_BIT() values. If ntypes is
+ * non-zero, the record type must be equal to one of the types. If
+ * media_type is set, only TNF_MEDIA_TYPE records of that type match
+ * (compared case-insensitively). It can be a wildcard as accepted by
+ * ndef_valid_mediatype(type, TRUE), i.e. the subtype (or both type and
+ * subtype) may be an asterisk.
+ *
+ * The record flags reflect the position of the record in the original
+ * message.
+ */
+#define NDEF_TNF_BIT(tnf) (1 << (tnf))
+
+typedef struct nfc_ndef_rec_filter {
+    guint tnf_mask;
+    const GUtilData* types;
+    guint ntypes;
+    const char* media_type;
+    guint max_matches;
+} NdefRecFilter;
+
+NdefRec*
+ndef_rec_new_filtered(
+    const GUtilData* block,
+    const NdefRecFilter* filter);
+
+/*
+ * Parses count independent inputs (TLV sequences if tlv is TRUE, NDEF
+ * messages otherwise) on up to the given number of threads, zero means
+ * one per CPU. The calling thread takes part in the work and the call
+ * returns when everything is done. results[i] receives what would be
+ * returned for inputs[i] by ndef_rec_new_opt() or
+ * ndef_rec_new_from_tlv_opt(), and so does status[i] (if status is
+ * not NULL). Returns the number of inputs which have been parsed. More
+ * than G_MAXINT/2 inputs are rejected, nothing is parsed in that case.
+ */
+guint
+ndef_rec_new_batch(
+    const GUtilData* inputs,
+    guint count,
+    gboolean tlv,
+    const NdefParseOpt* opt,
+    guint threads,
+    NdefRec** results,
+    NDEF_PARSE_RESULT* status);
+
+/*
+ * Parses the new contents of a previously parsed message, e.g. after
+ * the tag has been read again. If nothing has changed, a new reference
+ * to prev is returned. Otherwise only the unchanged records at the end
+ * of the message are shared with prev, i.e. keep their object identity.
+ * Other records having the same bytes as the record at the same position
+ * in prev are new objects, built from what has already been decoded
+ * rather than decoded again. Only the changed records are decoded. The
+ * new records are packed if prev was (see NDEF_PARSE_FLAG_PACKED). prev
+ * is not modified and may be NULL.
+ */
+NdefRec*
+ndef_rec_reparse(
+    NdefRec* prev,
+    const GUtilData* block);
+
+/*
+ * Optional per-thread pool of record objects. Once it's enabled on a
+ * thread, the generic, URI, Text and Smart Poster records created on
+ * that thread are recycled when released by their last ndef_rec_unref()
+ * (up to max_size of them are kept together with their buffers), and
+ * the parser reuses them instead of allocating new ones. The buffers
+ * are reused too, unless the records are packed (NDEF_PARSE_FLAG_PACKED).
+ *
+ * References to such records must only be taken and released with
+ * ndef_rec_ref() and ndef_rec_unref(), never with g_object_ref() and
+ * g_object_unref(). Don't attach anything to them either (data, weak
+ * references and such), it would outlive the record and stay attached
+ * to the recycled object.
+ *
+ * ndef_rec_pool_trim() releases the records which have stayed in the
+ * pool since the previous trim. Call it periodically, e.g. from an idle
+ * timer. Zero max_size disables the pool and frees everything in it.
+ * Whatever remains pooled is freed when the thread exits.
+ */
+void
+ndef_rec_pool_set_max_size(
+    guint max_size);
+
+void
+ndef_rec_pool_trim(
+    void);
+
+/*
+ * Optional cache of the records returned by ndef_rec_new() and
+ * ndef_rec_new_from_tlv(), for when the same data is parsed over and
+ * over again. It keeps up to max_size most recently used results
+ * (zero, the default, disables and empties the cache). A cache hit
+ * returns a new reference to the previously parsed chain, so records
+ * coming from these two functions may be shared and must be treated
+ * as read-only. The cache can be used from any thread.
+ */
+void
+ndef_rec_cache_set_max_size(
+    guint max_size);
+
+void
+ndef_rec_cache_clear(
+    void);
+
 NdefRec*
 ndef_rec_ref(
     NdefRec* rec);
@@ -112,6 +300,32 @@ void
 ndef_rec_unref(
     NdefRec* rec);
 
+/*
+ * Hash and equality of the record content (TNF, type, id and payload).
+ * They don't depend on the flags (MB/ME) and on how the record header
+ * is encoded (short or long payload length), so the same record found
+ * in different messages is equal to itself. The hash is calculated by
+ * the parser. The message variants compare the whole chains starting
+ * at the given records. All four can be used with GHashTable.
+ */
+guint
+ndef_rec_hash(
+    gconstpointer rec /* NdefRec* */);
+
+gboolean
+ndef_rec_equal(
+    gconstpointer a, /* NdefRec* */
+    gconstpointer b  /* NdefRec* */);
+
+guint
+ndef_rec_msg_hash(
+    gconstpointer first /* NdefRec* */);
+
+gboolean
+ndef_rec_msg_equal(
+    gconstpointer a, /* NdefRec* */
+    gconstpointer b  /* NdefRec* */);
+
 /* URI */
 
 typedef struct nfc_ndef_rec_u_priv NdefRecUPriv;
@@ -151,19 +365,6 @@ GType ndef_rec_t_get_type(void);
 #define NDEF_IS_REC_T(obj) G_TYPE_CHECK_INSTANCE_TYPE(obj, \
         NDEF_TYPE_REC_T)
 
-typedef enum nfc_ndef_rec_t_enc {
-    NDEF_REC_T_ENC_UTF8,
-    NDEF_REC_T_ENC_UTF16BE,
-    NDEF_REC_T_ENC_UTF16LE
-} NDEF_REC_T_ENC;
-
-typedef enum nfc_lang_match {
-    NDEF_LANG_MATCH_NONE = 0x00,
-    NDEF_LANG_MATCH_TERRITORY = 0x01,
-    NDEF_LANG_MATCH_LANGUAGE = 0x02,
-    NDEF_LANG_MATCH_FULL = NDEF_LANG_MATCH_LANGUAGE | NDEF_LANG_MATCH_TERRITORY
-} NDEF_LANG_MATCH;
-
 NdefRecT*
 ndef_rec_t_new_enc(
     const char* text,
@@ -186,20 +387,8 @@ ndef_rec_t_lang_compare(
 
 /* Smart poster */
 
-typedef enum nfc_ndef_sp_act {
-    NDEF_SP_ACT_DEFAULT = -1, /* No action record */
-    NDEF_SP_ACT_OPEN,         /* Perform the action */
-    NDEF_SP_ACT_SAVE,         /* Save for later */
-    NDEF_SP_ACT_EDIT          /* Open for editing */
-} NDEF_SP_ACT;
-
 typedef struct nfc_ndef_rec_sp_priv NdefRecSpPriv;
 
-typedef struct nfc_ndef_media {
-    GUtilData data;
-    const char* type;
-} NdefMedia;
-
 struct nfc_ndef_rec_sp {
     NdefRec rec;
     NdefRecSpPriv* priv;
@@ -229,17 +418,18 @@ ndef_rec_sp_new(
     NDEF_SP_ACT act,
     const NdefMedia* icon);
 
-/* Utilities */
-
-gboolean
-ndef_valid_mediatype(
-    const GUtilData* type,
-    gboolean wildcard);
-
-gboolean
-ndef_valid_mediatype_str(
-    const char* type,
-    gboolean wildcard);
+/*
+ * Optional one-time initialization. Does up front what would otherwise
+ * happen on the first parse: registers the record types, loads the
+ * UTF-16 iconv modules and interns the default language tag. Parsers
+ * still open their own converters (NdefParser keeps them open between
+ * calls), ndef_init() only keeps the modules loaded so that opening a
+ * converter doesn't have to load them. Can be called more than once
+ * and from any thread.
+ */
+void
+ndef_init(
+    void);
 
 G_END_DECLS
 
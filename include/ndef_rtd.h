@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef NDEF_RTD_H
+#define NDEF_RTD_H
+
+#include "ndef_types.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Plain C encoding and decoding of the well-known record types. This
+ * is what NdefRecU, NdefRecT and NdefRecSp are built upon, and it
+ * doesn't require GObject. The decoders take the record payload (e.g.
+ * NdefMsgRec.payload), the encoders produce one. Use ndef_msg_rec_encode()
+ * to wrap the payload into a record.
+ *
+ * The decoded structures are allocated as a single memory block, free
+ * them with g_free(). NULL is returned if the payload is invalid.
+ */
+
+/* NFCForum-TS-RTD_URI_1.0 */
+
+char*
+ndef_rtd_uri_decode(
+    const GUtilData* payload);
+
+GBytes*
+ndef_rtd_uri_encode(
+    const char* uri);
+
+/* NFCForum-TS-RTD_TEXT_1.0 */
+
+typedef struct ndef_rtd_text {
+    const char* lang;
+    const char* text;
+    NDEF_REC_T_ENC enc;
+} NdefRtdText;
+
+NdefRtdText*
+ndef_rtd_text_decode(
+    const GUtilData* payload);
+
+GBytes*
+ndef_rtd_text_encode(
+    const char* text,
+    const char* lang, /* System language if NULL */
+    NDEF_REC_T_ENC enc);
+
+NDEF_LANG_MATCH
+ndef_rtd_lang_match(
+    const char* tag, /* language[-territory] */
+    const NdefLanguage* lang);
+
+/*
+ * NFCForum-SmartPoster_RTD_1.0
+ *
+ * If there are several titles, the decoder picks the one that best
+ * matches the system language.
+ */
+
+typedef struct ndef_rtd_sp {
+    const char* uri;
+    const char* title;
+    const char* lang;
+    const char* type;
+    guint size;
+    NDEF_SP_ACT act;
+    const NdefMedia* icon;
+} NdefRtdSp;
+
+NdefRtdSp*
+ndef_rtd_sp_decode(
+    const GUtilData* payload);
+
+GBytes*
+ndef_rtd_sp_encode(
+    const char* uri,
+    const char* title,
+    const char* lang,
+    const char* type,
+    guint size,
+    NDEF_SP_ACT act,
+    const NdefMedia* icon);
+
+G_END_DECLS
+
+#endif /* NDEF_RTD_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -55,6 +55,46 @@ typedef struct nfc_ndef_rec_sp NdefRecSp;
 typedef struct nfc_ndef_rec_t NdefRecT;
 typedef struct nfc_ndef_rec_u NdefRecU;
 
+/* TNF = Type name format */
+typedef enum nfc_ndef_tnf {
+    NDEF_TNF_EMPTY,
+    NDEF_TNF_WELL_KNOWN,
+    NDEF_TNF_MEDIA_TYPE,
+    NDEF_TNF_ABSOLUTE_URI,
+    NDEF_TNF_EXTERNAL
+} NDEF_TNF;
+
+#define NDEF_TNF_MAX NDEF_TNF_EXTERNAL
+
+/* Text encoding */
+typedef enum nfc_ndef_rec_t_enc {
+    NDEF_REC_T_ENC_UTF8,
+    NDEF_REC_T_ENC_UTF16BE,
+    NDEF_REC_T_ENC_UTF16LE
+} NDEF_REC_T_ENC;
+
+/* Smart poster action */
+typedef enum nfc_ndef_sp_act {
+    NDEF_SP_ACT_DEFAULT = -1, /* No action record */
+    NDEF_SP_ACT_OPEN,         /* Perform the action */
+    NDEF_SP_ACT_SAVE,         /* Save for later */
+    NDEF_SP_ACT_EDIT          /* Open for editing */
+} NDEF_SP_ACT;
+
+/* Language match */
+typedef enum nfc_lang_match {
+    NDEF_LANG_MATCH_NONE = 0x00,
+    NDEF_LANG_MATCH_TERRITORY = 0x01,
+    NDEF_LANG_MATCH_LANGUAGE = 0x02,
+    NDEF_LANG_MATCH_FULL = NDEF_LANG_MATCH_LANGUAGE | NDEF_LANG_MATCH_TERRITORY
+} NDEF_LANG_MATCH;
+
+/* Smart poster icon */
+typedef struct nfc_ndef_media {
+    GUtilData data;
+    const char* type;
+} NdefMedia;
+
 /* Logging */
 
 #define NDEF_LOG_MODULE ndef_log
@@ -60,6 +60,89 @@ NdefLanguage*
 ndef_system_language(
     void);
 
+/* Media type syntax, see RFC 2045 */
+
+gboolean
+ndef_valid_mediatype(
+    const GUtilData* type,
+    gboolean wildcard);
+
+gboolean
+ndef_valid_mediatype_str(
+    const char* type,
+    gboolean wildcard);
+
+/*
+ * Interned strings. The same bytes give the same NUL-terminated string,
+ * which is never freed. The table has a fixed capacity. NULL is returned
+ * once it's full, for strings longer than 255 bytes and for the ones
+ * containing NUL characters.
+ */
+const char*
+ndef_intern(
+    const GUtilData* data);
+
+/*
+ * Warnings are rate limited per call site. No more than burst warnings
+ * per interval_ms get logged by each call site, the number of suppressed
+ * ones is reported when the next interval starts. Zero interval_ms turns
+ * rate limiting off. The default is 3 warnings per 10 seconds.
+ *
+ * The log level of NDEF_LOG_MODULE (e.g. set by gutil_log_parse_option
+ * from "ndef:<level>") decides what gets logged at all. Below
+ * GLOG_LEVEL_WARN nothing is, at GLOG_LEVEL_DEBUG and above the rate
+ * limiting is off. GLogModule has no room for the interval and burst,
+ * hence these two functions.
+ */
+void
+ndef_log_set_limit(
+    guint interval_ms,
+    guint burst);
+
+void
+ndef_log_get_limit(
+    guint* interval_ms,
+    guint* burst);
+
+/*
+ * Flight recorder of rejected inputs.
+ *
+ * The last NDEF_REJECT_MAX inputs rejected by the parser are kept in
+ * a fixed-size lock-free ring buffer. Only up to NDEF_REJECT_DATA_MAX
+ * bytes of each input are saved, starting at data_offset (which is
+ * chosen so that the bytes around the offending offset are captured).
+ * Nothing is done (and nothing costs anything) until something fails.
+ *
+ * ndef_reject_get() copies up to max entries, the oldest first, and
+ * returns the number of entries copied. ndef_reject_dump() writes the
+ * same thing to the log.
+ */
+#define NDEF_REJECT_MAX (16)
+#define NDEF_REJECT_DATA_MAX (48)
+
+typedef struct ndef_reject {
+    guint seq;              /* Sequence number of the rejection */
+    const char* reason;     /* Static string */
+    gsize size;             /* Full size of the rejected input */
+    gsize offset;           /* Offset of the problem in the input */
+    gsize data_offset;      /* Offset of the first saved byte */
+    guint data_size;        /* Number of bytes saved */
+    guint8 data[NDEF_REJECT_DATA_MAX];
+} NdefReject;
+
+guint
+ndef_reject_get(
+    NdefReject* buf,
+    guint max);
+
+void
+ndef_reject_dump(
+    void);
+
+void
+ndef_reject_clear(
+    void);
+
 G_END_DECLS
 
 #endif /* NDEF_UTIL_H */
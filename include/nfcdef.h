@@ -39,7 +39,10 @@
 #ifndef NFCDEF_H
 #define NFCDEF_H
 
+#include "ndef_msg.h"
+#include "ndef_pipeline.h"
 #include "ndef_rec.h"
+#include "ndef_rtd.h"
 #include "ndef_tlv.h"
 #include "ndef_util.h"
 #include "ndef_version.h"
@@ -7,7 +7,7 @@ License: BSD
 URL: https://github.com/sailfishos/libnfcdef
 Source: %{name}-%{version}.tar.bz2
 
-%define glib_version 2.32
+%define glib_version 2.38
 %define libglibutil_version 1.0.52
 
 BuildRequires: pkgconfig
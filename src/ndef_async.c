@@ -0,0 +1,334 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "ndef_async.h"
+#include "ndef_util_p.h"
+
+#include <gutil_misc.h>
+
+/*
+ * The input is copied by the calling thread into the task data, the
+ * result is passed back with g_task_return_pointer(). Since the tasks
+ * return on cancel, a result produced after the task has been cancelled
+ * is released by GTask.
+ */
+
+static
+void
+ndef_async_run(
+    gpointer tag,
+    gpointer data,
+    GDestroyNotify destroy,
+    GTaskThreadFunc func,
+    GCancellable* cancel,
+    GAsyncReadyCallback callback,
+    gpointer user_data)
+{
+    GTask* task = g_task_new(NULL, cancel, callback, user_data);
+
+    g_task_set_source_tag(task, tag);
+    g_task_set_task_data(task, data, destroy);
+    g_task_set_return_on_cancel(task, TRUE);
+    g_task_run_in_thread(task, func);
+    g_object_unref(task);
+}
+
+static
+void
+ndef_async_return(
+    GTask* task,
+    NdefRec* rec,
+    gint code,
+    const char* message)
+{
+    if (rec) {
+        g_task_return_pointer(task, rec, (GDestroyNotify) ndef_rec_unref);
+    } else {
+        g_task_return_new_error(task, G_IO_ERROR, code, "%s", message);
+    }
+}
+
+static
+void
+ndef_async_return_parsed(
+    GTask* task,
+    NdefRec* rec)
+{
+    ndef_async_return(task, rec, G_IO_ERROR_INVALID_DATA,
+        "Invalid NDEF data");
+}
+
+static
+void
+ndef_async_return_built(
+    GTask* task,
+    NdefRec* rec)
+{
+    ndef_async_return(task, rec, G_IO_ERROR_INVALID_ARGUMENT,
+        "Failed to build NDEF record");
+}
+
+static
+gpointer
+ndef_async_finish(
+    GAsyncResult* result,
+    gpointer tag,
+    GError** error)
+{
+    if (G_LIKELY(g_task_is_valid(result, NULL)) &&
+        g_task_get_source_tag(G_TASK(result)) == tag) {
+        return g_task_propagate_pointer(G_TASK(result), error);
+    }
+    return NULL;
+}
+
+static
+GBytes*
+ndef_async_bytes(
+    const GUtilData* data)
+{
+    return data ? g_bytes_new(data->bytes, data->size) : NULL;
+}
+
+static
+void
+ndef_async_parse_thread(
+    GTask* task,
+    gpointer object,
+    gpointer task_data,
+    GCancellable* cancel)
+{
+    if (!g_task_return_error_if_cancelled(task)) {
+        GUtilData block;
+
+        ndef_async_return_parsed(task, task_data ?
+            ndef_rec_new(gutil_data_from_bytes(&block, task_data)) :
+            NULL);
+    }
+}
+
+static
+void
+ndef_async_parse_tlv_thread(
+    GTask* task,
+    gpointer object,
+    gpointer task_data,
+    GCancellable* cancel)
+{
+    if (!g_task_return_error_if_cancelled(task)) {
+        GUtilData tlv;
+
+        ndef_async_return_parsed(task, task_data ?
+            ndef_rec_new_from_tlv(gutil_data_from_bytes(&tlv, task_data)) :
+            NULL);
+    }
+}
+
+static
+void
+ndef_async_u_thread(
+    GTask* task,
+    gpointer object,
+    gpointer task_data,
+    GCancellable* cancel)
+{
+    if (!g_task_return_error_if_cancelled(task)) {
+        NdefRecU* rec = ndef_rec_u_new(task_data);
+
+        ndef_async_return_built(task, rec ? &rec->rec : NULL);
+    }
+}
+
+static
+void
+ndef_async_t_thread(
+    GTask* task,
+    gpointer object,
+    gpointer task_data,
+    GCancellable* cancel)
+{
+    if (!g_task_return_error_if_cancelled(task)) {
+        const NdefRtdText* t = task_data;
+        NdefRecT* rec = ndef_rec_t_new_enc(t->text, t->lang, t->enc);
+
+        ndef_async_return_built(task, rec ? &rec->rec : NULL);
+    }
+}
+
+static
+void
+ndef_async_sp_thread(
+    GTask* task,
+    gpointer object,
+    gpointer task_data,
+    GCancellable* cancel)
+{
+    if (!g_task_return_error_if_cancelled(task)) {
+        const NdefRtdSp* sp = task_data;
+        NdefRecSp* rec = sp ? ndef_rec_sp_new(sp->uri, sp->title, sp->lang,
+            sp->type, sp->size, sp->act, sp->icon) : NULL;
+
+        ndef_async_return_built(task, rec ? &rec->rec : NULL);
+    }
+}
+
+/*==========================================================================*
+ * Interface
+ *==========================================================================*/
+
+void
+ndef_rec_new_async(
+    const GUtilData* block,
+    GCancellable* cancel,
+    GAsyncReadyCallback callback,
+    gpointer user_data)
+{
+    ndef_async_run(ndef_rec_new_async, ndef_async_bytes(block),
+        (GDestroyNotify) g_bytes_unref, ndef_async_parse_thread, cancel,
+        callback, user_data);
+}
+
+NdefRec*
+ndef_rec_new_finish(
+    GAsyncResult* result,
+    GError** error)
+{
+    return ndef_async_finish(result, ndef_rec_new_async, error);
+}
+
+void
+ndef_rec_new_from_tlv_async(
+    const GUtilData* tlv,
+    GCancellable* cancel,
+    GAsyncReadyCallback callback,
+    gpointer user_data)
+{
+    ndef_async_run(ndef_rec_new_from_tlv_async, ndef_async_bytes(tlv),
+        (GDestroyNotify) g_bytes_unref, ndef_async_parse_tlv_thread, cancel,
+        callback, user_data);
+}
+
+NdefRec*
+ndef_rec_new_from_tlv_finish(
+    GAsyncResult* result,
+    GError** error)
+{
+    return ndef_async_finish(result, ndef_rec_new_from_tlv_async, error);
+}
+
+void
+ndef_rec_u_new_async(
+    const char* uri,
+    GCancellable* cancel,
+    GAsyncReadyCallback callback,
+    gpointer user_data)
+{
+    ndef_async_run(ndef_rec_u_new_async, g_strdup(uri), g_free,
+        ndef_async_u_thread, cancel, callback, user_data);
+}
+
+NdefRecU*
+ndef_rec_u_new_finish(
+    GAsyncResult* result,
+    GError** error)
+{
+    return ndef_async_finish(result, ndef_rec_u_new_async, error);
+}
+
+void
+ndef_rec_t_new_async(
+    const char* text,
+    const char* lang,
+    NDEF_REC_T_ENC enc,
+    GCancellable* cancel,
+    GAsyncReadyCallback callback,
+    gpointer user_data)
+{
+    /* The default language is the one of the calling thread */
+    char* lang_tmp = lang ? NULL : ndef_default_lang_tag();
+
+    ndef_async_run(ndef_rec_t_new_async, ndef_rtd_text_new(text,
+        lang ? lang : lang_tmp, enc), g_free, ndef_async_t_thread,
+        cancel, callback, user_data);
+    g_free(lang_tmp);
+}
+
+NdefRecT*
+ndef_rec_t_new_finish(
+    GAsyncResult* result,
+    GError** error)
+{
+    return ndef_async_finish(result, ndef_rec_t_new_async, error);
+}
+
+void
+ndef_rec_sp_new_async(
+    const char* uri,
+    const char* title,
+    const char* lang,
+    const char* type,
+    guint size,
+    NDEF_SP_ACT act,
+    const NdefMedia* icon,
+    GCancellable* cancel,
+    GAsyncReadyCallback callback,
+    gpointer user_data)
+{
+    char* lang_tmp = (title && !lang) ? ndef_default_lang_tag() : NULL;
+
+    ndef_async_run(ndef_rec_sp_new_async, uri ? ndef_rtd_sp_new(uri, title,
+        lang ? lang : lang_tmp, type, size, act, icon, NULL, NULL) : NULL,
+        g_free, ndef_async_sp_thread, cancel, callback, user_data);
+    g_free(lang_tmp);
+}
+
+NdefRecSp*
+ndef_rec_sp_new_finish(
+    GAsyncResult* result,
+    GError** error)
+{
+    return ndef_async_finish(result, ndef_rec_sp_new_async, error);
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "ndef_rec_p.h"
+
+#include <gutil_misc.h>
+
+/*
+ * The converters are never used, they are only kept open so that the
+ * iconv modules remain loaded and the parser doesn't have to load them
+ * again on the first tap.
+ */
+static NdefScratch ndef_init_scratch;
+
+static
+gpointer
+ndef_init_once(
+    gpointer data)
+{
+    static const guint8 space[] = { 0x00, 0x20 };
+    GUtilData text, utf8;
+    char* tag;
+
+    /* Referencing the classes runs class_init for the whole hierarchy */
+    g_type_class_ref(NDEF_TYPE_REC_U);
+    g_type_class_ref(NDEF_TYPE_REC_T);
+    g_type_class_ref(NDEF_TYPE_REC_SP);
+
+    /* The byte order doesn't matter for the space character */
+    text.bytes = space;
+    text.size = sizeof(space);
+    ndef_scratch_init(&ndef_init_scratch);
+    ndef_scratch_utf16(&ndef_init_scratch, &text, NDEF_REC_T_ENC_UTF16LE,
+        &utf8);
+    ndef_scratch_utf16(&ndef_init_scratch, &text, NDEF_REC_T_ENC_UTF16BE,
+        &utf8);
+
+    /* This also queries the locale */
+    tag = ndef_default_lang_tag();
+    ndef_intern(gutil_data_from_string(&text, tag));
+    g_free(tag);
+    return NULL;
+}
+
+/*==========================================================================*
+ * Interface
+ *==========================================================================*/
+
+void
+ndef_init(
+    void)
+{
+    static GOnce once = G_ONCE_INIT;
+
+    g_once(&once, ndef_init_once, NULL);
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
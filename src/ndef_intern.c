@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "ndef_util_p.h"
+
+#include <gutil_misc.h>
+
+/*
+ * Interned strings are never freed, so the table is bounded. Once it's
+ * full, the callers fall back to keeping their own copies. The strings
+ * are allocated together with their keys.
+ */
+#define NDEF_INTERN_MAX_COUNT (1024)
+#define NDEF_INTERN_MAX_SIZE (255)
+
+static GHashTable* ndef_intern_table = NULL;
+
+G_LOCK_DEFINE_STATIC(ndef_intern);
+
+static
+guint
+ndef_intern_hash(
+    gconstpointer key)
+{
+    return ndef_hash_data(NDEF_HASH_INIT, key);
+}
+
+static
+gboolean
+ndef_intern_equal(
+    gconstpointer a,
+    gconstpointer b)
+{
+    return gutil_data_equal(a, b);
+}
+
+/*==========================================================================*
+ * Interface
+ *==========================================================================*/
+
+const char*
+ndef_intern(
+    const GUtilData* data)
+{
+    const char* str = NULL;
+
+    if (G_LIKELY(data) && data->size <= NDEF_INTERN_MAX_SIZE &&
+        (!data->size || !memchr(data->bytes, 0, data->size))) {
+        GUtilData* key;
+
+        G_LOCK(ndef_intern);
+        if (!ndef_intern_table) {
+            ndef_intern_table = g_hash_table_new(ndef_intern_hash,
+                ndef_intern_equal);
+        }
+        key = g_hash_table_lookup(ndef_intern_table, data);
+        if (key) {
+            str = (const char*) key->bytes;
+        } else if (g_hash_table_size(ndef_intern_table) <
+            NDEF_INTERN_MAX_COUNT) {
+            char* copy;
+
+            key = g_malloc(sizeof(GUtilData) + data->size + 1);
+            copy = (char*)(key + 1);
+            if (data->size) {
+                memcpy(copy, data->bytes, data->size);
+            }
+            copy[data->size] = 0;
+            key->bytes = (const guint8*) copy;
+            key->size = data->size;
+            g_hash_table_add(ndef_intern_table, key);
+            str = copy;
+        }
+        G_UNLOCK(ndef_intern);
+    }
+    return str;
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
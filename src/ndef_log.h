@@ -44,6 +44,24 @@
 #define GLOG_MODULE_NAME NDEF_LOG_MODULE
 #include <gutil_log.h>
 
+/* Per call site state of the warning rate limiter */
+typedef struct ndef_log_limiter {
+    const char* what;
+    gint64 start;
+    guint count;
+    guint suppressed;
+} NdefLogLimiter;
+
+gboolean
+ndef_log_limit_check(
+    NdefLogLimiter* limiter)
+    G_GNUC_INTERNAL;
+
+#define NDEF_WARN(f,args...) do { \
+        static NdefLogLimiter ndef_log_limiter = { f, 0, 0, 0 }; \
+        if (ndef_log_limit_check(&ndef_log_limiter)) GWARN(f, ##args); \
+    } while (0)
+
 #endif /* NDEF_LOG_H */
 
 /*
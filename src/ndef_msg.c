@@ -0,0 +1,685 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "ndef_msg.h"
+#include "ndef_util_p.h"
+#include "ndef_log.h"
+
+#include <gutil_misc.h>
+
+/* The raw record immediately follows the header */
+struct ndef_msg_rec_pack {
+    guint32 size;
+    guint16 payload_offset;
+    guint8 type_offset;
+};
+
+/* TNF values not covered by NDEF_TNF */
+#define NDEF_TNF_UNKNOWN   (0x05)
+#define NDEF_TNF_UNCHANGED (0x06)
+
+/*
+ * Decodes the header of the record at the beginning of the block and
+ * advances the block past the record. Nothing is read beyond the end
+ * of the block.
+ */
+gboolean
+ndef_data_parse(
+    GUtilData* block,
+    NdefData* ndef,
+    const char** error)
+{
+    if (block->size < 3) {
+        /* At least 3 bytes is required for anything meaningful */
+        *error = "Block is too short to be an NDEF record";
+        GDEBUG("%s", *error);
+        return FALSE;
+    } else {
+        const guint8 hdr = block->bytes[0];
+        guint total_len = 1;
+
+        memset(ndef, 0, sizeof(*ndef));
+
+        /* TYPE LENGTH, PAYLOAD LENGTH and (optional) ID LENGTH */
+        ndef->type_offset = 1 + 1 + ((hdr & NDEF_HDR_SR) ? 1 : 4) +
+            ((hdr & NDEF_HDR_IL) ? 1 : 0);
+        if (block->size < ndef->type_offset) {
+            *error = "Truncated NDEF record header";
+            GDEBUG("%s", *error);
+            return FALSE;
+        }
+
+        /* Type */
+        ndef->type_length = block->bytes[1];
+        total_len += 1 + ndef->type_length;
+
+        /* Payload length */
+        if (hdr & NDEF_HDR_SR) {
+            /* Short record */
+            ndef->payload_length = block->bytes[2];
+            total_len += 1 + ndef->payload_length;
+        } else {
+            /* 4 bytes for length */
+            ndef->payload_length =
+                (((guint)block->bytes[2]) << 24) |
+                (((guint)block->bytes[3]) << 16) |
+                (((guint)block->bytes[4]) << 8) |
+                ((guint)block->bytes[5]);
+            total_len += 4 + ndef->payload_length;
+        }
+
+        /* ID Length */
+        if (hdr & NDEF_HDR_IL) {
+            ndef->id_length = block->bytes[ndef->type_offset - 1];
+            total_len += 1 + ndef->id_length;
+        }
+
+        /* Check for overflow */
+        if (ndef->payload_length < 0x80000000 && total_len <= block->size) {
+            /* Cut the garbage if there is any */
+            ndef->rec.bytes = block->bytes;
+            ndef->rec.size = total_len;
+            block->bytes += total_len;
+            block->size -= total_len;
+            return TRUE;
+        } else {
+            *error = "Garbage (lengths don't add up)";
+            GDEBUG("%s", *error);
+        }
+        return FALSE;
+    }
+}
+
+gboolean
+ndef_type(
+    const NdefData* ndef,
+    GUtilData* type)
+{
+    if (ndef && ndef->type_length) {
+        type->bytes = ndef->rec.bytes + ndef->type_offset;
+        type->size = ndef->type_length;
+        return TRUE;
+    } else {
+        type->bytes = NULL;
+        type->size = 0;
+        return FALSE;
+    }
+}
+
+gboolean
+ndef_payload(
+    const NdefData* ndef,
+    GUtilData* payload)
+{
+    if (ndef && ndef->payload_length) {
+        payload->bytes = ndef->rec.bytes + ndef->type_offset +
+            ndef->type_length + ndef->id_length;
+        payload->size = ndef->payload_length;
+        return TRUE;
+    } else {
+        payload->bytes = NULL;
+        payload->size = 0;
+        return FALSE;
+    }
+}
+
+/*
+ * Builds the record header (everything preceding the TYPE field) and
+ * returns its length, zero if the sizes don't fit. SR and IL flags are
+ * calculated here, the rest of the header comes from the caller.
+ */
+guint
+ndef_rec_header(
+    guint8* head, /* NDEF_REC_HEADER_MAX bytes */
+    guint8 hdr,
+    gsize type_len,
+    gsize id_len,
+    gsize payload_len)
+{
+    if (type_len <= 0xff && id_len <= 0xff && payload_len < 0x80000000) {
+        guint n = 0;
+
+        hdr &= ~(NDEF_HDR_SR | NDEF_HDR_IL);
+        if (payload_len <= 0xff) {
+            /* Short record */
+            hdr |= NDEF_HDR_SR;
+        }
+        if (id_len) {
+            hdr |= NDEF_HDR_IL;
+        }
+
+        /* Header, TYPE LENGTH, PAYLOAD LENGTH and ID LENGTH */
+        head[n++] = hdr;
+        head[n++] = (guint8) type_len;
+        if (hdr & NDEF_HDR_SR) {
+            head[n++] = (guint8) payload_len;
+        } else {
+            /* 32-bit unsigned integer, MSB-first */
+            head[n++] = (guint8) (payload_len >> 24);
+            head[n++] = (guint8) (payload_len >> 16);
+            head[n++] = (guint8) (payload_len >> 8);
+            head[n++] = (guint8) payload_len;
+        }
+        if (id_len) {
+            head[n++] = (guint8) id_len;
+        }
+        return n;
+    }
+    return 0;
+}
+
+/* Appends a complete record to the buffer */
+gboolean
+ndef_rec_append(
+    GByteArray* buf,
+    guint8 hdr,
+    const GUtilData* type,
+    const GUtilData* id,
+    const GUtilData* payload)
+{
+    const gsize type_len = type ? type->size : 0;
+    const gsize id_len = id ? id->size : 0;
+    const gsize payload_len = payload ? payload->size : 0;
+    guint8 head[NDEF_REC_HEADER_MAX];
+    const guint n = ndef_rec_header(head, hdr, type_len, id_len,
+        payload_len);
+
+    if (n) {
+        g_byte_array_append(buf, head, n);
+
+        /* TYPE, ID and PAYLOAD */
+        if (type_len) {
+            g_byte_array_append(buf, type->bytes, type_len);
+        }
+        if (id_len) {
+            g_byte_array_append(buf, id->bytes, id_len);
+        }
+        if (payload_len) {
+            g_byte_array_append(buf, payload->bytes, payload_len);
+        }
+        return TRUE;
+    }
+    return FALSE;
+}
+
+static
+gboolean
+ndef_msg_check_rec(
+    const NdefMsgRec* rec,
+    gboolean first,
+    gboolean chunk)
+{
+    const guint8 hdr = rec->hdr;
+
+    /* NFCForum-TS-NDEF_1.0 */
+    if (!(hdr & NDEF_HDR_MB) != !first) {
+        GDEBUG("MB flag is misplaced");
+        return FALSE;
+    } else if ((hdr & NDEF_HDR_CF) && (hdr & NDEF_HDR_ME)) {
+        GDEBUG("Message ends with a non-terminating chunk");
+        return FALSE;
+    } else if (chunk) {
+        /*
+         * 2.3.3 Record Chunks
+         *
+         * Middle and terminating record chunks MUST have the TNF field
+         * set to 0x06 (Unchanged), TYPE_LENGTH set to zero and the IL
+         * flag cleared.
+         */
+        if (rec->tnf != NDEF_TNF_UNCHANGED || rec->type.size ||
+            (hdr & NDEF_HDR_IL)) {
+            GDEBUG("Invalid record chunk");
+            return FALSE;
+        }
+    } else {
+        /* 3.2.6 TNF (Type Name Format) */
+        switch (hdr & NDEF_HDR_TNF_MASK) {
+        case NDEF_TNF_EMPTY:
+            if (!rec->type.size && !rec->id.size && !rec->payload.size) {
+                return TRUE;
+            }
+            break;
+        case NDEF_TNF_WELL_KNOWN:
+        case NDEF_TNF_MEDIA_TYPE:
+        case NDEF_TNF_ABSOLUTE_URI:
+        case NDEF_TNF_EXTERNAL:
+            if (rec->type.size) {
+                return TRUE;
+            }
+            break;
+        case NDEF_TNF_UNKNOWN:
+            if (!rec->type.size) {
+                return TRUE;
+            }
+            break;
+        }
+        GDEBUG("Invalid TNF 0x%02x or TYPE_LENGTH %u", rec->tnf,
+            (guint) rec->type.size);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static
+gboolean
+ndef_msg_visit_data(
+    const GUtilData* msg,
+    const NdefMsgVisitor* v,
+    gpointer user_data,
+    gboolean sp);
+
+static
+gboolean
+ndef_msg_visit_sp_rec(
+    const NdefMsgRec* rec,
+    const NdefMsgVisitor* v,
+    gpointer user_data)
+{
+    /* Smart Poster specific records, NFCForum-SmartPoster_RTD_1.0 */
+    if (rec->tnf == NDEF_TNF_WELL_KNOWN) {
+        const GUtilData* payload = &rec->payload;
+
+        if (gutil_data_equal(&rec->type, &ndef_sp_type_act)) {
+            /* 3.3.3 The Recommended Action Record */
+            if (payload->size == 1 && payload->bytes[0] <= NDEF_SP_ACT_EDIT) {
+                return !v->sp_act || v->sp_act(rec, (NDEF_SP_ACT)
+                    payload->bytes[0], user_data);
+            }
+        } else if (gutil_data_equal(&rec->type, &ndef_sp_type_s)) {
+            /* 3.3.5 The Size Record */
+            if (payload->size == 4) {
+                return !v->sp_size || v->sp_size(rec,
+                    (((guint32)payload->bytes[0]) << 24) |
+                    (((guint32)payload->bytes[1]) << 16) |
+                    (((guint32)payload->bytes[2]) << 8) |
+                     ((guint32)payload->bytes[3]), user_data);
+            }
+        } else if (gutil_data_equal(&rec->type, &ndef_sp_type_t)) {
+            /* 3.3.6 The Type Record */
+            if (ndef_valid_mediatype(payload, FALSE)) {
+                return !v->sp_type || v->sp_type(rec, payload, user_data);
+            }
+        }
+    } else if (rec->tnf == NDEF_TNF_MEDIA_TYPE) {
+        static const GUtilData image = { (const guint8*) "image/", 6 };
+        static const GUtilData video = { (const guint8*) "video/", 6 };
+
+        /* 3.3.4 The Icon Record */
+        if (rec->payload.size > 0 &&
+            ndef_valid_mediatype(&rec->type, FALSE) &&
+            (gutil_data_has_prefix(&rec->type, &image) ||
+             gutil_data_has_prefix(&rec->type, &video))) {
+            return !v->sp_icon || v->sp_icon(rec, &rec->type,
+                &rec->payload, user_data);
+        }
+    }
+    return !v->other || v->other(rec, user_data);
+}
+
+static
+gboolean
+ndef_msg_visit_rec(
+    const NdefMsgRec* rec,
+    const NdefMsgVisitor* v,
+    gpointer user_data,
+    gboolean sp)
+{
+    if (rec->hdr & NDEF_HDR_CF) {
+        /* Chunked records are not decoded */
+    } else if (rec->tnf == NDEF_TNF_WELL_KNOWN) {
+        if (gutil_data_equal(&rec->type, &ndef_rec_type_u)) {
+            GUtilData prefix, suffix;
+
+            if (ndef_uri_split(&rec->payload, &prefix, &suffix)) {
+                return !v->uri || v->uri(rec, &prefix, &suffix, user_data);
+            }
+        } else if (gutil_data_equal(&rec->type, &ndef_rec_type_t)) {
+            GUtilData lang, text;
+            NDEF_REC_T_ENC enc;
+
+            if (ndef_text_split(&rec->payload, &lang, &text, &enc)) {
+                return !v->text || v->text(rec, &lang, &text, enc,
+                    user_data);
+            }
+        } else if (!sp && gutil_data_equal(&rec->type, &ndef_rec_type_sp)) {
+            /* The content of a Smart Poster payload is an NDEF message */
+            return (!v->sp_start || v->sp_start(rec, user_data)) &&
+                ndef_msg_visit_data(&rec->payload, v, user_data, TRUE) &&
+                (!v->sp_end || v->sp_end(rec, user_data));
+        } else if (sp) {
+            return ndef_msg_visit_sp_rec(rec, v, user_data);
+        }
+    } else if (sp) {
+        return ndef_msg_visit_sp_rec(rec, v, user_data);
+    }
+    return !v->other || v->other(rec, user_data);
+}
+
+static
+gboolean
+ndef_msg_visit_data(
+    const GUtilData* msg,
+    const NdefMsgVisitor* v,
+    gpointer user_data,
+    gboolean sp)
+{
+    NdefMsgIter it;
+    NdefMsgRec rec;
+
+    ndef_msg_iter_init(&it, msg);
+    while (ndef_msg_iter_next(&it, &rec)) {
+        if (!ndef_msg_visit_rec(&rec, v, user_data, sp)) {
+            return FALSE;
+        }
+    }
+    return !it.data.size;
+}
+
+/*==========================================================================*
+ * Interface
+ *==========================================================================*/
+
+void
+ndef_msg_iter_init(
+    NdefMsgIter* iter,
+    const GUtilData* msg)
+{
+    if (G_LIKELY(iter)) {
+        memset(iter, 0, sizeof(*iter));
+        if (msg) {
+            iter->data = *msg;
+        }
+    }
+}
+
+gboolean
+ndef_msg_iter_next(
+    NdefMsgIter* iter,
+    NdefMsgRec* rec)
+{
+    if (G_LIKELY(iter) && iter->data.size) {
+        GUtilData data = iter->data;
+        const char* error = NULL;
+        NdefData ndef;
+
+        if (ndef_data_parse(&data, &ndef, &error)) {
+            if (rec) {
+                const guint8* type = ndef.rec.bytes + ndef.type_offset;
+
+                rec->hdr = ndef.rec.bytes[0];
+                rec->tnf = rec->hdr & NDEF_HDR_TNF_MASK;
+                rec->raw = ndef.rec;
+                rec->type.bytes = type;
+                rec->type.size = ndef.type_length;
+                rec->id.bytes = type + ndef.type_length;
+                rec->id.size = ndef.id_length;
+                rec->payload.bytes = rec->id.bytes + ndef.id_length;
+                rec->payload.size = ndef.payload_length;
+            }
+            iter->offset += ndef.rec.size;
+            iter->data = data;
+            return TRUE;
+        }
+    }
+    if (rec) {
+        memset(rec, 0, sizeof(*rec));
+    }
+    return FALSE;
+}
+
+NdefMsgIndex*
+ndef_msg_index_new(
+    const GUtilData* msg)
+{
+    NdefMsgIndex* index = NULL;
+    NdefMsgIter it;
+    guint max = 0, n = 0;
+
+    ndef_msg_iter_init(&it, msg);
+    for (;;) {
+        const gsize offset = it.offset;
+        NdefMsgIndexEntry* entry;
+
+        if (!ndef_msg_iter_next(&it, NULL) || it.offset > G_MAXUINT32) {
+            break;
+        }
+
+        /* The table immediately follows NdefMsgIndex */
+        if (n == max) {
+            max = max ? (max * 2) : 8;
+            index = g_realloc(index, sizeof(NdefMsgIndex) +
+                max * sizeof(NdefMsgIndexEntry));
+        }
+        entry = (NdefMsgIndexEntry*)(index + 1) + (n++);
+        entry->offset = (guint32) offset;
+        entry->size = (guint32) (it.offset - offset);
+    }
+
+    if (index) {
+        /* Drop the excess */
+        index = g_realloc(index, sizeof(NdefMsgIndex) +
+            n * sizeof(NdefMsgIndexEntry));
+        index->count = n;
+        index->entry = (NdefMsgIndexEntry*)(index + 1);
+    }
+    return index;
+}
+
+gboolean
+ndef_msg_index_get(
+    const NdefMsgIndex* index,
+    const GUtilData* msg,
+    guint i,
+    NdefMsgRec* rec)
+{
+    if (G_LIKELY(index) && G_LIKELY(msg) && i < index->count) {
+        const NdefMsgIndexEntry* entry = index->entry + i;
+
+        if ((gsize) entry->offset + entry->size <= msg->size) {
+            NdefMsgIter it;
+
+            memset(&it, 0, sizeof(it));
+            it.data.bytes = msg->bytes + entry->offset;
+            it.data.size = entry->size;
+            if (ndef_msg_iter_next(&it, rec)) {
+                return TRUE;
+            }
+        }
+    }
+    if (rec) {
+        memset(rec, 0, sizeof(*rec));
+    }
+    return FALSE;
+}
+
+NdefMsgRecPack*
+ndef_msg_rec_pack(
+    const GUtilData* raw)
+{
+    if (G_LIKELY(raw)) {
+        GUtilData data = *raw;
+        const char* error = NULL;
+        NdefData ndef;
+
+        if (ndef_data_parse(&data, &ndef, &error) &&
+            ndef.rec.size <= G_MAXUINT32) {
+            NdefMsgRecPack* pack = g_malloc(sizeof(NdefMsgRecPack) +
+                ndef.rec.size);
+
+            pack->size = (guint32) ndef.rec.size;
+            pack->type_offset = (guint8) ndef.type_offset;
+            pack->payload_offset = (guint16) (ndef.type_offset +
+                ndef.type_length + ndef.id_length);
+            memcpy(pack + 1, ndef.rec.bytes, ndef.rec.size);
+            return pack;
+        }
+    }
+    return NULL;
+}
+
+gboolean
+ndef_msg_rec_unpack(
+    const NdefMsgRecPack* pack,
+    NdefMsgRec* rec)
+{
+    if (G_LIKELY(pack) && G_LIKELY(rec)) {
+        const guint8* raw = (const guint8*)(pack + 1);
+
+        rec->hdr = raw[0];
+        rec->tnf = rec->hdr & NDEF_HDR_TNF_MASK;
+        rec->raw.bytes = raw;
+        rec->raw.size = pack->size;
+        rec->type.bytes = raw + pack->type_offset;
+        rec->type.size = raw[1];
+        rec->id.bytes = rec->type.bytes + rec->type.size;
+        rec->id.size = pack->payload_offset - pack->type_offset -
+            rec->type.size;
+        rec->payload.bytes = raw + pack->payload_offset;
+        rec->payload.size = pack->size - pack->payload_offset;
+        return TRUE;
+    }
+    if (rec) {
+        memset(rec, 0, sizeof(*rec));
+    }
+    return FALSE;
+}
+
+gsize
+ndef_msg_check(
+    const GUtilData* msg,
+    gsize* error_offset)
+{
+    gsize offset = 0;
+
+    if (G_LIKELY(msg)) {
+        gboolean chunk = FALSE;
+        NdefMsgIter it;
+        NdefMsgRec rec;
+
+        ndef_msg_iter_init(&it, msg);
+        while (ndef_msg_iter_next(&it, &rec) &&
+            ndef_msg_check_rec(&rec, !offset, chunk)) {
+            if (rec.hdr & NDEF_HDR_ME) {
+                /* Anything beyond ME doesn't belong to the message */
+                return it.offset;
+            }
+            chunk = (rec.hdr & NDEF_HDR_CF) != 0;
+            offset = it.offset;
+        }
+    }
+    if (error_offset) {
+        *error_offset = offset;
+    }
+    return 0;
+}
+
+gboolean
+ndef_msg_visit(
+    const GUtilData* msg,
+    const NdefMsgVisitor* visitor,
+    gpointer user_data)
+{
+    if (G_LIKELY(msg) && G_LIKELY(visitor)) {
+        return ndef_msg_visit_data(msg, visitor, user_data, FALSE);
+    }
+    return FALSE;
+}
+
+GBytes*
+ndef_msg_rec_encode(
+    guint8 hdr,
+    const GUtilData* type,
+    const GUtilData* id,
+    const GUtilData* payload)
+{
+    GByteArray* buf = g_byte_array_new();
+
+    if (ndef_rec_append(buf, hdr, type, id, payload)) {
+        return g_byte_array_free_to_bytes(buf);
+    }
+    g_byte_array_free(buf, TRUE);
+    return NULL;
+}
+
+char*
+ndef_msg_decode_uri(
+    const GUtilData* prefix,
+    const GUtilData* suffix)
+{
+    const gsize prefix_len = prefix ? prefix->size : 0;
+    const gsize suffix_len = suffix ? suffix->size : 0;
+    char* uri = g_malloc(prefix_len + suffix_len + 1);
+
+    if (prefix_len) {
+        memcpy(uri, prefix->bytes, prefix_len);
+    }
+    if (suffix_len) {
+        memcpy(uri + prefix_len, suffix->bytes, suffix_len);
+    }
+    uri[prefix_len + suffix_len] = 0;
+    return uri;
+}
+
+char*
+ndef_msg_decode_text(
+    const GUtilData* text,
+    NDEF_REC_T_ENC enc)
+{
+    return G_LIKELY(text) ? ndef_text_decode(text, enc) : NULL;
+}
+
+/*==========================================================================*
+ * Internal interface
+ *==========================================================================*/
+
+gboolean
+ndef_msg_visit_sp(
+    const GUtilData* content,
+    const NdefMsgVisitor* visitor,
+    gpointer user_data)
+{
+    return ndef_msg_visit_data(content, visitor, user_data, TRUE);
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
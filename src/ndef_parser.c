@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "ndef_rec_p.h"
+
+struct ndef_parser {
+    NdefParseOpt opt;
+    NdefScratch scratch;
+};
+
+/*==========================================================================*
+ * Interface
+ *==========================================================================*/
+
+NdefParser*
+ndef_parser_new(
+    const NdefParseOpt* opt)
+{
+    NdefParser* parser = g_new0(NdefParser, 1);
+
+    if (opt) {
+        parser->opt = *opt;
+    }
+    ndef_scratch_init(&parser->scratch);
+    return parser;
+}
+
+void
+ndef_parser_free(
+    NdefParser* parser)
+{
+    if (G_LIKELY(parser)) {
+        ndef_scratch_clear(&parser->scratch);
+        g_free(parser);
+    }
+}
+
+NdefRec*
+ndef_parser_parse(
+    NdefParser* parser,
+    const GUtilData* block,
+    NDEF_PARSE_RESULT* result)
+{
+    return G_LIKELY(parser) ? ndef_rec_parse_block(block, &parser->opt,
+        &parser->scratch, result) : ndef_rec_new_opt(block, NULL, result);
+}
+
+NdefRec*
+ndef_parser_parse_tlv(
+    NdefParser* parser,
+    const GUtilData* tlv,
+    NDEF_PARSE_RESULT* result)
+{
+    return G_LIKELY(parser) ? ndef_rec_parse_tlv(tlv, &parser->opt,
+        &parser->scratch, result) : ndef_rec_new_from_tlv_opt(tlv, NULL,
+        result);
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
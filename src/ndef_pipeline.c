@@ -0,0 +1,296 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "ndef_pipeline.h"
+#include "ndef_rec_p.h"
+
+/*
+ * The queue is a ring of slots indexed by the sequence number. Three
+ * counters move through it: the next input to deliver (head), the next
+ * input to parse and the next free slot (tail). A worker grabs the next
+ * input, parses it outside the lock and then, unless another worker is
+ * already doing it, delivers all completed results starting from head.
+ * Delivery frees the slots, which wakes up the blocked producer. If
+ * there are no options, the inputs go through the parse cache,
+ * otherwise each thread has its own parser context.
+ */
+
+typedef struct ndef_pipeline_slot {
+    GBytes* data;
+    NdefRec* rec;
+    gboolean done;
+} NdefPipelineSlot;
+
+struct ndef_pipeline {
+    GMutex mutex;
+    GCond work;
+    GCond space;
+    GThread** threads;
+    guint nthreads;
+    NdefPipelineSlot* slots;
+    guint capacity;
+    guint64 head;
+    guint64 next;
+    guint64 tail;
+    gboolean delivering;
+    gboolean stopping;
+    gboolean tlv;
+    NdefParseOpt opt;
+    const NdefParseOpt* opt_ptr;
+    NdefPipelineFunc func;
+    gpointer user_data;
+    gint64 start;
+    NdefPipelineStats stats;
+};
+
+static
+void
+ndef_pipeline_deliver(
+    NdefPipeline* pipe)
+{
+    while (pipe->head < pipe->next) {
+        const guint64 seq = pipe->head;
+        NdefPipelineSlot* slot = pipe->slots + (seq % pipe->capacity);
+        GBytes* data = slot->data;
+        NdefRec* rec = slot->rec;
+
+        if (!slot->done) {
+            break;
+        }
+
+        /* The slot stays occupied until the callback returns */
+        g_mutex_unlock(&pipe->mutex);
+        pipe->func(seq, rec, pipe->user_data);
+        ndef_rec_unref(rec);
+        g_bytes_unref(data);
+        g_mutex_lock(&pipe->mutex);
+
+        memset(slot, 0, sizeof(*slot));
+        pipe->head++;
+        pipe->stats.delivered++;
+        if (!rec) {
+            pipe->stats.failed++;
+        }
+        g_cond_broadcast(&pipe->space);
+    }
+}
+
+static
+gpointer
+ndef_pipeline_run(
+    gpointer user_data)
+{
+    NdefPipeline* pipe = user_data;
+    NdefParser* parser = pipe->opt_ptr ? ndef_parser_new(pipe->opt_ptr) :
+        NULL;
+
+    g_mutex_lock(&pipe->mutex);
+    for (;;) {
+        if (pipe->next < pipe->tail) {
+            NdefPipelineSlot* slot = pipe->slots +
+                (pipe->next++ % pipe->capacity);
+            GUtilData block;
+            NdefRec* rec;
+            gint64 start;
+
+            g_mutex_unlock(&pipe->mutex);
+            start = g_get_monotonic_time();
+            block.bytes = g_bytes_get_data(slot->data, &block.size);
+            if (!parser) {
+                rec = ndef_rec_cache_parse(&block, pipe->tlv ?
+                    ndef_rec_new_from_tlv_opt : ndef_rec_new_opt);
+            } else if (pipe->tlv) {
+                rec = ndef_parser_parse_tlv(parser, &block, NULL);
+            } else {
+                rec = ndef_parser_parse(parser, &block, NULL);
+            }
+            start = g_get_monotonic_time() - start;
+            g_mutex_lock(&pipe->mutex);
+
+            slot->rec = rec;
+            slot->done = TRUE;
+            pipe->stats.parse_us += start;
+            if (!pipe->delivering) {
+                pipe->delivering = TRUE;
+                ndef_pipeline_deliver(pipe);
+                pipe->delivering = FALSE;
+            }
+        } else if (pipe->stopping) {
+            /*
+             * Whatever has been parsed by now, gets delivered either
+             * by the thread that parsed it or by the one which was
+             * delivering at that time.
+             */
+            break;
+        } else {
+            g_cond_wait(&pipe->work, &pipe->mutex);
+        }
+    }
+    g_mutex_unlock(&pipe->mutex);
+    ndef_parser_free(parser);
+    return NULL;
+}
+
+/*==========================================================================*
+ * Interface
+ *==========================================================================*/
+
+NdefPipeline*
+ndef_pipeline_new(
+    guint threads,
+    guint capacity,
+    gboolean tlv,
+    const NdefParseOpt* opt,
+    NdefPipelineFunc func,
+    gpointer user_data)
+{
+    if (G_LIKELY(func)) {
+        NdefPipeline* pipe = g_new0(NdefPipeline, 1);
+        guint i;
+
+        if (!threads) {
+            threads = g_get_num_processors();
+        }
+        if (!capacity) {
+            capacity = 2 * threads;
+        }
+
+        g_mutex_init(&pipe->mutex);
+        g_cond_init(&pipe->work);
+        g_cond_init(&pipe->space);
+        pipe->slots = g_new0(NdefPipelineSlot, capacity);
+        pipe->capacity = capacity;
+        pipe->tlv = tlv;
+        if (opt) {
+            pipe->opt = *opt;
+            pipe->opt_ptr = &pipe->opt;
+        }
+        pipe->func = func;
+        pipe->user_data = user_data;
+        pipe->start = g_get_monotonic_time();
+        pipe->nthreads = threads;
+        pipe->threads = g_new(GThread*, threads);
+        for (i = 0; i < threads; i++) {
+            pipe->threads[i] = g_thread_new("ndef-pipeline",
+                ndef_pipeline_run, pipe);
+        }
+        return pipe;
+    }
+    return NULL;
+}
+
+guint64
+ndef_pipeline_submit(
+    NdefPipeline* pipe,
+    const GUtilData* data)
+{
+    if (G_LIKELY(pipe)) {
+        GBytes* bytes = data ? g_bytes_new(data->bytes, data->size) :
+            g_bytes_new(NULL, 0);
+        NdefPipelineSlot* slot;
+        guint64 seq;
+        guint queued;
+
+        g_mutex_lock(&pipe->mutex);
+        if (pipe->tail - pipe->head >= pipe->capacity) {
+            pipe->stats.blocked++;
+            do {
+                g_cond_wait(&pipe->space, &pipe->mutex);
+            } while (pipe->tail - pipe->head >= pipe->capacity);
+        }
+        seq = pipe->tail++;
+        slot = pipe->slots + (seq % pipe->capacity);
+        slot->data = bytes;
+        queued = (guint) (pipe->tail - pipe->head);
+        pipe->stats.submitted++;
+        pipe->stats.max_queued = MAX(pipe->stats.max_queued, queued);
+        g_cond_signal(&pipe->work);
+        g_mutex_unlock(&pipe->mutex);
+        return seq;
+    }
+    return 0;
+}
+
+void
+ndef_pipeline_get_stats(
+    NdefPipeline* pipe,
+    NdefPipelineStats* stats)
+{
+    if (G_LIKELY(stats)) {
+        if (G_LIKELY(pipe)) {
+            g_mutex_lock(&pipe->mutex);
+            *stats = pipe->stats;
+            stats->queued = (guint) (pipe->tail - pipe->head);
+            stats->elapsed_us = g_get_monotonic_time() - pipe->start;
+            g_mutex_unlock(&pipe->mutex);
+        } else {
+            memset(stats, 0, sizeof(*stats));
+        }
+    }
+}
+
+void
+ndef_pipeline_free(
+    NdefPipeline* pipe)
+{
+    if (G_LIKELY(pipe)) {
+        guint i;
+
+        g_mutex_lock(&pipe->mutex);
+        pipe->stopping = TRUE;
+        g_cond_broadcast(&pipe->work);
+        g_mutex_unlock(&pipe->mutex);
+        for (i = 0; i < pipe->nthreads; i++) {
+            g_thread_join(pipe->threads[i]);
+        }
+        g_free(pipe->threads);
+        g_free(pipe->slots);
+        g_cond_clear(&pipe->space);
+        g_cond_clear(&pipe->work);
+        g_mutex_clear(&pipe->mutex);
+        g_free(pipe);
+    }
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
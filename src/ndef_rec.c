@@ -44,26 +44,57 @@
 
 #include <gutil_misc.h>
 
-GLOG_MODULE_DEFINE("ndef");
-
+/*
+ * Caches may hold lots of records, keep this one small (32 bytes on
+ * 64-bit systems). The allocated size saturates at G_MAXUINT, which
+ * merely means that such a huge buffer won't be reused.
+ */
 struct nfc_ndef_rec_priv {
     guint8* data;
+    NdefSlab* slab;
+    guint alloc;
+    guint hash;
+    gboolean poolable;  /* References are counted by refs */
+    gint refs;
 };
 
+#define NDEF_REC_ALLOC(size) ((guint) MIN(size, G_MAXUINT))
+
+/* Larger buffers are not kept by pooled records */
+#define NDEF_REC_POOL_MAX_BUF (4096)
+
+/*
+ * With NDEF_PARSE_FLAG_PACKED, records of a parsed message (and whatever
+ * is stored after each of them, i.e. decoded strings) are packed into
+ * a few slabs, in the same order as they appear in the message. A slab
+ * is freed when the last record referencing it is gone. New slabs are
+ * sized for the rest of the message, with some extra room for the
+ * decoded strings.
+ */
+struct ndef_slab {
+    gint ref_count;
+    gsize size;
+    gsize used;
+};
+
+#define NDEF_SLAB_HINT(remaining) ((remaining) + (remaining) / 4 + 64)
+
 #define THIS(obj) NDEF_REC(obj)
 #define THIS_TYPE NDEF_TYPE_REC
 #define PARENT_TYPE G_TYPE_OBJECT
 #define PARENT_CLASS ndef_rec_parent_class
 
-G_DEFINE_TYPE(NdefRec, ndef_rec, PARENT_TYPE)
+G_DEFINE_TYPE_WITH_PRIVATE(NdefRec, ndef_rec, PARENT_TYPE)
 
 static
 NdefRec*
 ndef_rec_alloc(
-    const NdefData* ndef)
+    const NdefData* ndef,
+    NdefParseCtx* ctx)
 {
     if (ndef->rec.size) {
         const NDEF_TNF tnf = ndef->rec.bytes[0] & NDEF_HDR_TNF_MASK;
+        NdefRec* rec;
 
         /* Handle known types */
         if (tnf == NDEF_TNF_WELL_KNOWN) {
@@ -71,7 +102,7 @@ ndef_rec_alloc(
 
             ndef_type(ndef, &type);
             if (gutil_data_equal(&type, &ndef_rec_type_u)) {
-                NdefRecU* uri_rec = ndef_rec_u_new_from_data(ndef);
+                NdefRecU* uri_rec = ndef_rec_u_new_from_data(ndef, ctx);
 
                 if (uri_rec) {
                     /* URI Record */
@@ -79,7 +110,7 @@ ndef_rec_alloc(
                     return THIS(uri_rec);
                 }
             } else if (gutil_data_equal(&type, &ndef_rec_type_t)) {
-                NdefRecT* text_rec = ndef_rec_t_new_from_data(ndef);
+                NdefRecT* text_rec = ndef_rec_t_new_from_data(ndef, ctx);
 
                 if (text_rec) {
                     /* TEXT Record */
@@ -89,81 +120,268 @@ ndef_rec_alloc(
                     return THIS(text_rec);
                 }
             } else if (gutil_data_equal(&type, &ndef_rec_type_sp)) {
-                NdefRecSp* sp_rec = ndef_rec_sp_new_from_data(ndef);
+                NdefRecSp* sp_rec = ndef_rec_sp_new_from_data(ndef, ctx);
 
                 if (sp_rec) {
                     /* SmartPoster Record */
                     GVERBOSE("SmartPoster URI: %s", sp_rec->uri);
                     return THIS(sp_rec);
+                } else if (ctx->result != NDEF_PARSE_OK) {
+                    /* Nested parsing has hit the limit */
+                    return NULL;
                 }
             }
         }
 
         /* Generic record */
-        return ndef_rec_initialize(g_object_new(THIS_TYPE, NULL),
-            NDEF_RTD_UNKNOWN, ndef);
+        rec = ndef_rec_object_new(THIS_TYPE);
+        ndef_rec_initialize_spare(rec, NDEF_RTD_UNKNOWN, ndef, 0, ctx);
+        return rec;
     } else {
         /* Special case - Empty NDEF */
-        return g_object_new(THIS_TYPE, NULL);
+        return ndef_rec_object_new(THIS_TYPE);
     }
 }
 
 static
 gboolean
-ndef_rec_parse(
-    GUtilData* block,
-    NdefData* ndef)
+ndef_parse_ctx_check(
+    NdefParseCtx* ctx,
+    const NdefData* ndef)
 {
-    if (block->size < 3) {
-        /* At least 3 bytes is required for anything meaningful */
-        GDEBUG("Block is too short to be an NDEF record");
-        return FALSE;
+    const NdefParseOpt* opt = &ctx->opt;
+
+    ctx->records++;
+    ctx->bytes += sizeof(NdefRec) + ndef->rec.size;
+    if (opt->max_records && ctx->records > opt->max_records) {
+        GDEBUG("Too many records");
+        ctx->result = NDEF_PARSE_LIMIT_RECORDS;
+    } else if (opt->max_bytes && ctx->bytes > opt->max_bytes) {
+        GDEBUG("Too much memory");
+        ctx->result = NDEF_PARSE_LIMIT_BYTES;
+    } else if (ctx->deadline && g_get_monotonic_time() > ctx->deadline) {
+        GDEBUG("Parsing is taking too long");
+        ctx->result = NDEF_PARSE_LIMIT_TIME;
     } else {
-        const guint8 hdr = block->bytes[0];
-        guint total_len = 1;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+static
+gboolean
+ndef_rec_filter_media_type(
+    const GUtilData* type,
+    const char* pattern)
+{
+    const char* sub = strchr(pattern, '/');
+    const guint8* tsub = type->size ? memchr(type->bytes, '/', type->size) :
+        NULL;
 
-        memset(ndef, 0, sizeof(*ndef));
-        ndef->type_length = block->bytes[1];
+    if (sub && tsub) {
+        const gsize len = sub - pattern;
+        const gsize tlen = tsub - type->bytes;
+        const gsize tsublen = type->size - tlen - 1;
 
-        /* Type */
-        total_len += 1 + ndef->type_length;
-        ndef->type_offset = 2;
+        sub++;
+        tsub++;
+        return ((len == 1 && pattern[0] == '*') || (len == tlen &&
+            !g_ascii_strncasecmp(pattern, (const char*)type->bytes, len))) &&
+            ((sub[0] == '*' && !sub[1]) || (strlen(sub) == tsublen &&
+            !g_ascii_strncasecmp(sub, (const char*)tsub, tsublen)));
+    }
+    return FALSE;
+}
 
-        /* Payload length */
-        if (hdr & NDEF_HDR_SR) {
-            /* Short record */
-            ndef->payload_length = block->bytes[ndef->type_offset++];
-            total_len += 1 + ndef->payload_length;
-        } else {
-            /* 4 bytes for length */
-            ndef->payload_length =
-                (((guint)block->bytes[ndef->type_offset]) << 24) |
-                (((guint)block->bytes[ndef->type_offset + 1]) << 16) |
-                (((guint)block->bytes[ndef->type_offset + 2]) << 8) |
-                ((guint)block->bytes[ndef->type_offset + 3]);
-            total_len += 4 + ndef->payload_length;
-            ndef->type_offset += 4;
+static
+gboolean
+ndef_rec_filter_match(
+    NdefParseCtx* ctx,
+    const NdefData* ndef)
+{
+    const NdefRecFilter* filter = ctx->filter;
+
+    /* The filter only applies to the top-level records */
+    if (filter && ctx->depth == 1) {
+        const NDEF_TNF tnf = ndef->rec.size ?
+            (ndef->rec.bytes[0] & NDEF_HDR_TNF_MASK) : NDEF_TNF_EMPTY;
+        GUtilData type;
+
+        ndef_type(ndef, &type);
+        if (filter->tnf_mask && !(filter->tnf_mask & NDEF_TNF_BIT(tnf))) {
+            return FALSE;
         }
+        if (filter->ntypes) {
+            guint i;
 
-        /* ID Length */
-        if (hdr & NDEF_HDR_IL) {
-            ndef->id_length = block->bytes[ndef->type_offset++];
-            total_len += 1 + ndef->id_length;
+            for (i = 0; i < filter->ntypes &&
+                !gutil_data_equal(&type, filter->types + i); i++);
+            if (i == filter->ntypes) {
+                return FALSE;
+            }
+        }
+        if (filter->media_type && (tnf != NDEF_TNF_MEDIA_TYPE ||
+            !ndef_rec_filter_media_type(&type, filter->media_type))) {
+            return FALSE;
         }
+    }
+    return TRUE;
+}
 
-        /* Check for overflow */
-        if (ndef->payload_length < 0x80000000 && total_len <= block->size) {
-            /* Cut the garbage if there is any */
-            ndef->rec.bytes = block->bytes;
-            ndef->rec.size = total_len;
-            block->bytes += total_len;
-            block->size -= total_len;
-            return TRUE;
-        } else {
-            GDEBUG("Garbage (lengths don't add up)");
+static
+gboolean
+ndef_rec_filter_done(
+    NdefParseCtx* ctx)
+{
+    const NdefRecFilter* filter = ctx->filter;
+
+    return filter && ctx->depth == 1 && filter->max_matches &&
+        ++(ctx->matches) >= filter->max_matches;
+}
+
+/* Reuses the existing buffer if it's large enough */
+static
+guint8*
+ndef_rec_buffer(
+    NdefRec* self,
+    gsize size)
+{
+    NdefRecPriv* priv = self->priv;
+
+    if (priv->alloc < size) {
+        g_free(priv->data);
+        priv->data = g_malloc(size);
+        priv->alloc = NDEF_REC_ALLOC(size);
+    }
+    return priv->data;
+}
+
+static
+void
+ndef_slab_unref(
+    NdefSlab* slab)
+{
+    if (slab && g_atomic_int_dec_and_test(&slab->ref_count)) {
+        g_free(slab);
+    }
+}
+
+/* Returns NULL if the record doesn't go to a slab */
+static
+guint8*
+ndef_slab_alloc(
+    NdefParseCtx* ctx,
+    gsize size,
+    NdefSlab** out)
+{
+    if (ctx && ctx->slab_hint) {
+        NdefSlab* slab = ctx->slab;
+        guint8* ptr;
+
+        if (!slab || (slab->size - slab->used) < size) {
+            const gsize n = MAX(size, ctx->slab_hint);
+
+            /* Start a new one, the context holds a reference */
+            ndef_slab_unref(slab);
+            ctx->slab = slab = g_malloc(sizeof(NdefSlab) + n);
+            slab->ref_count = 1;
+            slab->size = n;
+            slab->used = 0;
         }
-        return FALSE;
+        ptr = ((guint8*)(slab + 1)) + slab->used;
+        slab->used += size;
+        g_atomic_int_inc(&slab->ref_count);
+        *out = slab;
+        return ptr;
     }
+    return NULL;
+}
+
+/*
+ * The hash covers the TNF, type, id and payload, i.e. doesn't depend
+ * on the position of the record in the message (MB/ME) and on how the
+ * lengths are encoded (SR/IL). TNF is taken from the header since the
+ * public tnf field can't represent Unknown and Unchanged.
+ */
+static
+guint8
+ndef_rec_tnf_bits(
+    const NdefRec* self)
+{
+    return self->raw.size ? (self->raw.bytes[0] & NDEF_HDR_TNF_MASK) :
+        NDEF_TNF_EMPTY;
+}
+
+static
+guint
+ndef_rec_compute_hash(
+    const NdefRec* self)
+{
+    guint hash = ndef_hash_uint(NDEF_HASH_INIT, ndef_rec_tnf_bits(self));
+
+    hash = ndef_hash_data(hash, &self->type);
+    hash = ndef_hash_data(hash, &self->id);
+    return ndef_hash_data(hash, &self->payload);
+}
+
+static
+void
+ndef_rec_set_data(
+    NdefRec* self,
+    NDEF_RTD rtd,
+    const NdefData* ndef)
+{
+    const GUtilData* rec = &ndef->rec;
+    const guint hdr = rec->bytes[0];
+    const guint8 tnf = (hdr & NDEF_HDR_TNF_MASK);
+
+    if (tnf < NDEF_TNF_MAX) {
+        self->tnf = tnf;
+    }
+    if (hdr & NDEF_HDR_MB) {
+        self->flags |= NDEF_REC_FLAG_FIRST;
+    }
+    if (hdr & NDEF_HDR_ME) {
+        self->flags |= NDEF_REC_FLAG_LAST;
+    }
+    self->rtd = rtd;
+    self->raw = *rec;
+    self->type.bytes = self->raw.bytes + ndef->type_offset;
+    self->type.size = ndef->type_length;
+    if (ndef->id_length > 0) {
+        self->id.bytes = self->type.bytes + ndef->type_length;
+        self->id.size = ndef->id_length;
+    }
+    if (ndef->payload_length) {
+        self->payload.size = ndef->payload_length;
+        self->payload.bytes = self->type.bytes + ndef->type_length +
+            ndef->id_length;
+    }
+
+    /* The bytes have just been copied, hashing them is cheap */
+    self->priv->hash = ndef_rec_compute_hash(self);
+}
+
+/*
+ * Takes ownership of the buffer (ndef->rec), which starts the block,
+ * unless it's the record's own buffer already.
+ */
+static
+NdefRec*
+ndef_rec_take_data(
+    NdefRec* self,
+    NDEF_RTD rtd,
+    const NdefData* ndef)
+{
+    NdefRecPriv* priv = self->priv;
+
+    if (priv->data != ndef->rec.bytes) {
+        g_free(priv->data);
+        priv->data = (guint8*) ndef->rec.bytes;
+        priv->alloc = NDEF_REC_ALLOC(ndef->rec.size);
+    }
+    ndef_rec_set_data(self, rtd, ndef);
+    return self;
 }
 
 static
@@ -175,70 +393,14 @@ ndef_rec_new_from_data(
     const GUtilData* type,
     const GUtilData* payload)
 {
-    /* type and payload pointers are checked by the caller */
-    if (gtype &&
-#if GLIB_SIZEOF_SIZE_T > 4
-        payload->size <= 0xffffffff &&
-#endif
-        type->size <= 0xff) {
-        NdefData ndef;
-        NdefRec* rec;
-        guint8 hdr = NDEF_HDR_MB | NDEF_HDR_ME | (tnf & NDEF_HDR_TNF_MASK);
-        const guint8 type_length = type->size;
-        const gboolean sr = (payload->size <= 0xff); /* Short Record) */
-        GByteArray* buf = g_byte_array_sized_new((sr ? 3 : 6) + type_length +
-            payload->size);
+    guint8* dest;
+    NdefRec* rec = ndef_rec_new_with_payload(gtype, tnf, rtd, type,
+        payload->size, 0, &dest);
 
-        memset(&ndef, 0, sizeof(ndef));
-        ndef.type_length = type_length;
-        ndef.payload_length = payload->size;
-
-        /* Header, TYPE LENGTH and PAYLOAD LENGTH */
-        if (sr) {
-            guint8 payload_len = (guint8)payload->size;
-
-            /*
-             * If the SR flag is set, the PAYLOAD_LENGTH field is a single
-             * octet representing an 8-bit unsigned integer.
-             */
-            hdr |= NDEF_HDR_SR;
-            g_byte_array_append(buf, &hdr, 1);
-            g_byte_array_append(buf, &type_length, 1);
-            g_byte_array_append(buf, &payload_len, 1);
-        } else {
-            guint8 payload_length[4];
-
-            /*
-             * If the SR flag is clear, the PAYLOAD_LENGTH field is four
-             * octets representing a 32-bit unsigned integer. Transmission
-             * order of the octets is MSB-first.
-             */
-            payload_length[0] = (guint8)(payload->size >> 24);
-            payload_length[1] = (guint8)(payload->size >> 16);
-            payload_length[2] = (guint8)(payload->size >> 8);
-            payload_length[3] = (guint8)payload->size;
-            g_byte_array_append(buf, &hdr, 1);
-            g_byte_array_append(buf, &type_length, 1);
-            g_byte_array_append(buf, payload_length, 4);
-        }
-
-        /* TYPE */
-        ndef.type_offset = buf->len;
-        g_byte_array_append(buf, type->bytes, type->size);
-
-        /* PAYLOAD */
-        g_byte_array_append(buf, payload->bytes, payload->size);
-
-        /* Allocate the object */
-        ndef.rec.bytes = buf->data;
-        ndef.rec.size = buf->len;
-        rec = ndef_rec_initialize(g_object_new(gtype, NULL), rtd, &ndef);
-
-        g_byte_array_free(buf, TRUE);
-        return rec;
-    } else {
-        return NULL;
+    if (rec && payload->size) {
+        memcpy(dest, payload->bytes, payload->size);
     }
+    return rec;
 }
 
 static
@@ -257,28 +419,6 @@ ndef_rec_map_flags(
     return ndef_flags;
 }
 
-/* See RFC 2045, section 5.1 "Syntax of the Content-Type Header Field" */
-
-static
-gboolean
-ndef_is_token_char(
-    guint8 c)
-{
-    /*  token := 1*<any (US-ASCII) CHAR except SPACE, CTLs, or tspecials> */
-    if (c < 0x80) {
-        static const guint32 token_chars[] = {
-            0x00000000, /* ................................ */
-            0x03ff6cfa, /*  !"#$%&'()*+,-./0123456789:;<=>? */
-            0xc7fffffe, /* @ABCDEFGHIJKLMNOPQRSTUVWXYZ[\]^_ */
-            0x7fffffff  /* `abcdefghijklmnopqrstuvwxyz{|}~. */
-        };
-        if (token_chars[c/32] & (1 << (c % 32))) {
-            return TRUE;
-        }
-    }
-    return FALSE;
-}
-
 /*==========================================================================*
  * Interface
  *==========================================================================*/
@@ -287,74 +427,162 @@ NdefRec*
 ndef_rec_new(
     const GUtilData* block)
 {
-    NdefRec* first = NULL;
+    return ndef_rec_cache_parse(block, ndef_rec_new_opt);
+}
 
-    if (G_LIKELY(block)) {
-        NdefData ndef;
+NdefRec*
+ndef_rec_new_from_tlv(
+    const GUtilData* tlv)
+{
+    return ndef_rec_cache_parse(tlv, ndef_rec_new_from_tlv_opt);
+}
 
-        memset(&ndef, 0, sizeof(ndef));
-        if (G_LIKELY(block->size)) {
-            GUtilData data = *block;
-            NdefRec* last = NULL;
-
-            while (data.size > 0 && ndef_rec_parse(&data, &ndef)) {
-                GASSERT(ndef.rec.size);
-                if (ndef.rec.bytes[0] & NDEF_HDR_CF) {
-                    /* Who needs those anyway? */
-                    GWARN("Chunked records are not supported");
-                } else {
-                    NdefRec* rec;
+NdefRec*
+ndef_rec_new_opt(
+    const GUtilData* block,
+    const NdefParseOpt* opt,
+    NDEF_PARSE_RESULT* result)
+{
+    return ndef_rec_parse_block(block, opt, NULL, result);
+}
 
-                    GDEBUG("NDEF:");
-                    ndef_hexdump_data(&ndef.rec);
-                    rec = ndef_rec_alloc(&ndef);
-                    if (last) {
-                        last->next = rec;
-                        last = rec;
-                    } else {
-                        first = last = rec;
-                    }
-                }
-            }
-        } else {
-            /* Special case - Empty NDEF */
-            GDEBUG("Empty NDEF");
-            first = ndef_rec_alloc(&ndef);
+NdefRec*
+ndef_rec_new_filtered(
+    const GUtilData* block,
+    const NdefRecFilter* filter)
+{
+    if (G_LIKELY(block)) {
+        NdefParseCtx ctx;
+
+        if (filter && filter->media_type &&
+            !ndef_valid_mediatype_str(filter->media_type, TRUE) &&
+            !ndef_valid_mediatype_str(filter->media_type, FALSE)) {
+            GDEBUG("Invalid media type filter \"%s\"", filter->media_type);
+            return NULL;
         }
+        ndef_parse_ctx_init(&ctx, NULL);
+        ctx.filter = filter;
+        return ndef_rec_parse_message(block, &ctx);
     }
-    return first;
+    return NULL;
 }
 
 NdefRec*
-ndef_rec_new_from_tlv(
-    const GUtilData* tlv)
+ndef_rec_new_from_tlv_opt(
+    const GUtilData* tlv,
+    const NdefParseOpt* opt,
+    NDEF_PARSE_RESULT* result)
+{
+    return ndef_rec_parse_tlv(tlv, opt, NULL, result);
+}
+
+NdefRec*
+ndef_rec_reparse(
+    NdefRec* prev,
+    const GUtilData* block)
 {
     NdefRec* first = NULL;
+    NdefRec* rec;
+    GPtrArray* old;
+    GArray* recs;
+    GUtilData data;
+    const char* error = NULL;
+    guint n, k;
 
-    if (G_LIKELY(tlv)) {
-        GUtilData buf = *tlv, value;
+    if (!prev || !block || !block->size) {
+        return ndef_rec_new(block);
+    }
+
+    /*
+     * Find the record boundaries first. Anything unusual (garbage,
+     * chunked records) is left to the full parser.
+     */
+    recs = g_array_new(FALSE, FALSE, sizeof(NdefData));
+    data = *block;
+    while (data.size > 0) {
+        NdefData ndef;
+
+        if (!ndef_data_parse(&data, &ndef, &error) ||
+            (ndef.rec.bytes[0] & NDEF_HDR_CF)) {
+            g_array_free(recs, TRUE);
+            return ndef_rec_new(block);
+        }
+        g_array_append_val(recs, ndef);
+    }
+
+    old = g_ptr_array_new();
+    for (rec = prev; rec; rec = rec->next) {
+        g_ptr_array_add(old, rec);
+    }
+
+    /*
+     * Unchanged records at the end of the message are shared with the
+     * previous chain. The ones before that can't be shared because
+     * they point to different next records.
+     */
+    n = recs->len;
+    for (k = 0; k < n && k < old->len; k++) {
+        const NdefData* ndef = &g_array_index(recs, NdefData, n - k - 1);
+        const NdefRec* shared = old->pdata[old->len - k - 1];
+
+        if (!gutil_data_equal(&ndef->rec, &shared->raw)) {
+            break;
+        }
+    }
+
+    if (k == n) {
+        /* Nothing has changed (or some records have been removed) */
+        first = ndef_rec_ref(old->pdata[old->len - k]);
+    } else {
+        const guint8* end = k ?
+            g_array_index(recs, NdefData, n - k).rec.bytes :
+            (block->bytes + block->size);
+        /* New records are packed if the old ones were */
+        const gboolean packed = old->len &&
+            ((NdefRec*)old->pdata[0])->priv->slab;
         NdefRec* last = NULL;
-        guint type;
+        NdefParseCtx ctx;
+        guint i;
 
-        while ((type = ndef_tlv_next(&buf, &value)) > 0) {
-            if (type == TLV_NDEF_MESSAGE) {
-                NdefRec* rec = ndef_rec_new(&value);
+        ndef_parse_ctx_init(&ctx, NULL);
+        ctx.depth = 1;
+        for (i = 0; i < n - k; i++) {
+            const NdefData* ndef = &g_array_index(recs, NdefData, i);
+            NdefRec* src = (i < old->len) ? old->pdata[i] : NULL;
 
-                if (rec) {
-                    if (last) {
-                        last->next = rec;
-                    } else {
-                        first = rec;
-                    }
-                    /* ndef_rec_new() can return a chain */
-                    last = rec;
-                    while (last->next) {
-                        last = last->next;
-                    }
+            if (packed) {
+                ctx.slab_hint = NDEF_SLAB_HINT(end - ndef->rec.bytes);
+            }
+
+            /* Unchanged records aren't decoded again */
+            rec = NULL;
+            if (src && gutil_data_equal(&ndef->rec, &src->raw)) {
+                rec = NDEF_REC_GET_CLASS(src)->dup(src, ndef, &ctx);
+            }
+            if (!rec) {
+                rec = ndef_rec_alloc(ndef, &ctx);
+            }
+            if (rec) {
+                if (last) {
+                    last->next = rec;
+                } else {
+                    first = rec;
                 }
+                last = rec;
+            }
+        }
+        if (k) {
+            rec = ndef_rec_ref(old->pdata[old->len - k]);
+            if (last) {
+                last->next = rec;
+            } else {
+                first = rec;
             }
         }
+        ndef_slab_unref(ctx.slab);
     }
+    g_ptr_array_free(old, TRUE);
+    g_array_free(recs, TRUE);
     return first;
 }
 
@@ -372,12 +600,49 @@ ndef_rec_new_mediatype(
     return NULL;
 }
 
+NdefRec*
+ndef_rec_new_mediatype_take(
+    const GUtilData* type,
+    GBytes* payload)
+{
+    NdefRec* rec = NULL;
+
+    if (!payload) {
+        rec = ndef_rec_new_mediatype(type, NULL);
+    } else if (ndef_valid_mediatype(type, FALSE)) {
+        gsize size;
+        const void* data = g_bytes_get_data(payload, &size);
+        guint8* dest;
+
+        /*
+         * The raw record has to be contiguous, so the payload can't be
+         * used in place. The record buffer is allocated once and the
+         * payload is copied into it exactly once.
+         */
+        rec = ndef_rec_new_with_payload(THIS_TYPE, NDEF_TNF_MEDIA_TYPE,
+            NDEF_RTD_UNKNOWN, type, size, 0, &dest);
+        if (rec && size) {
+            memcpy(dest, data, size);
+        }
+    }
+    if (payload) {
+        g_bytes_unref(payload);
+    }
+    return rec;
+}
+
 NdefRec*
 ndef_rec_ref(
     NdefRec* self)
 {
     if (G_LIKELY(self)) {
-        g_object_ref(THIS(self));
+        NdefRecPriv* priv = self->priv;
+
+        if (priv->poolable) {
+            g_atomic_int_inc(&priv->refs);
+        } else {
+            g_object_ref(THIS(self));
+        }
     }
     return self;
 }
@@ -387,94 +652,281 @@ ndef_rec_unref(
     NdefRec* self)
 {
     if (G_LIKELY(self)) {
-        g_object_unref(THIS(self));
+        NdefRecPriv* priv = self->priv;
+
+        /*
+         * A poolable record holds a single GObject reference, which
+         * is released (unless the record gets recycled) when the last
+         * of its own references is gone.
+         */
+        if (!priv->poolable) {
+            g_object_unref(THIS(self));
+        } else if (g_atomic_int_dec_and_test(&priv->refs) &&
+            !ndef_rec_pool_put(self)) {
+            g_object_unref(THIS(self));
+        }
     }
 }
 
+guint
+ndef_rec_hash(
+    gconstpointer rec)
+{
+    const NdefRec* self = rec;
+
+    return G_LIKELY(self) ? self->priv->hash : 0;
+}
+
 gboolean
-ndef_valid_mediatype(
-    const GUtilData* type,
-    gboolean wildcard)
+ndef_rec_equal(
+    gconstpointer a,
+    gconstpointer b)
 {
-    if (type) {
-        guint i = 0;
+    const NdefRec* r1 = a;
+    const NdefRec* r2 = b;
 
-        if (type->size > 0) {
-            if (type->bytes[i] == (guint8)'*') {
-                if (wildcard) {
-                    i++;
-                } else {
-                    return FALSE;
-                }
-            } else {
-                while (i < type->size && ndef_is_token_char(type->bytes[i])) {
-                    i++;
-                }
-            }
-        }
-        if (i > 0 && (i + 1) < type->size && type->bytes[i] == (guint8)'/') {
-            i++;
-            if ((i + 1) == type->size && type->bytes[i] == (guint8)'*') {
-                return wildcard;
-            } else {
-                while (i < type->size && ndef_is_token_char(type->bytes[i])) {
-                    i++;
-                }
-                if (i == type->size) {
-                    return !wildcard;
-                }
-            }
-        }
+    if (r1 == r2) {
+        return TRUE;
+    } else if (!r1 || !r2) {
+        return FALSE;
+    } else {
+        return r1->priv->hash == r2->priv->hash &&
+            ndef_rec_tnf_bits(r1) == ndef_rec_tnf_bits(r2) &&
+            gutil_data_equal(&r1->type, &r2->type) &&
+            gutil_data_equal(&r1->id, &r2->id) &&
+            gutil_data_equal(&r1->payload, &r2->payload);
     }
-    return FALSE;
+}
+
+guint
+ndef_rec_msg_hash(
+    gconstpointer first)
+{
+    const NdefRec* rec = first;
+    guint hash = NDEF_HASH_INIT;
+
+    for (; rec; rec = rec->next) {
+        hash = ndef_hash_uint(hash, rec->priv->hash);
+    }
+    return hash;
 }
 
 gboolean
-ndef_valid_mediatype_str(
-    const char* type,
-    gboolean wildcard)
+ndef_rec_msg_equal(
+    gconstpointer a,
+    gconstpointer b)
 {
-    GUtilData data;
+    const NdefRec* r1 = a;
+    const NdefRec* r2 = b;
 
-    return type && ndef_valid_mediatype(gutil_data_from_string(&data, type),
-        wildcard);
+    while (r1 && r2 && r1 != r2) {
+        if (!ndef_rec_equal(r1, r2)) {
+            return FALSE;
+        }
+        r1 = r1->next;
+        r2 = r2->next;
+    }
+    return r1 == r2;
 }
 
 /*==========================================================================*
  * Internal interface
  *==========================================================================*/
 
-gboolean
-ndef_type(
-    const NdefData* ndef,
-    GUtilData* type)
+NdefRec*
+ndef_rec_parse_block(
+    const GUtilData* block,
+    const NdefParseOpt* opt,
+    NdefScratch* scratch,
+    NDEF_PARSE_RESULT* result)
 {
-    if (ndef && ndef->type_length) {
-        type->bytes = ndef->rec.bytes + ndef->type_offset;
-        type->size = ndef->type_length;
-        return TRUE;
-    } else {
-        type->bytes = NULL;
-        type->size = 0;
-        return FALSE;
+    NdefRec* rec = NULL;
+    NdefParseCtx ctx;
+
+    ndef_parse_ctx_init(&ctx, opt);
+    ctx.scratch = scratch;
+    if (G_LIKELY(block)) {
+        rec = ndef_rec_parse_message(block, &ctx);
+    }
+    if (!rec && ctx.result == NDEF_PARSE_OK) {
+        ctx.result = NDEF_PARSE_ERROR;
+    }
+    if (result) {
+        *result = ctx.result;
     }
+    return rec;
 }
 
+NdefRec*
+ndef_rec_parse_tlv(
+    const GUtilData* tlv,
+    const NdefParseOpt* opt,
+    NdefScratch* scratch,
+    NDEF_PARSE_RESULT* result)
+{
+    NdefRec* first = NULL;
+    NdefParseCtx ctx;
+
+    ndef_parse_ctx_init(&ctx, opt);
+    ctx.scratch = scratch;
+    if (G_LIKELY(tlv)) {
+        GUtilData buf = *tlv, value;
+        NdefRec* last = NULL;
+        guint type;
+
+        while ((type = ndef_tlv_next(&buf, &value)) > 0) {
+            if (type == TLV_NDEF_MESSAGE) {
+                NdefRec* rec = ndef_rec_parse_message(&value, &ctx);
+
+                if (rec) {
+                    if (last) {
+                        last->next = rec;
+                    } else {
+                        first = rec;
+                    }
+                    /* ndef_rec_parse_message() can return a chain */
+                    last = rec;
+                    while (last->next) {
+                        last = last->next;
+                    }
+                } else if (ctx.result != NDEF_PARSE_OK) {
+                    /* Drop everything if any limit has been hit */
+                    ndef_rec_unref(first);
+                    first = NULL;
+                    break;
+                }
+            }
+        }
+    }
+    if (!first && ctx.result == NDEF_PARSE_OK) {
+        ctx.result = NDEF_PARSE_ERROR;
+    }
+    if (result) {
+        *result = ctx.result;
+    }
+    return first;
+}
+
+void
+ndef_parse_ctx_init(
+    NdefParseCtx* ctx,
+    const NdefParseOpt* opt)
+{
+    memset(ctx, 0, sizeof(*ctx));
+    if (opt) {
+        ctx->opt = *opt;
+        if (opt->max_time_ms) {
+            ctx->deadline = g_get_monotonic_time() +
+                (gint64) opt->max_time_ms * 1000;
+        }
+    }
+}
+
+NdefRec*
+ndef_rec_parse_message(
+    const GUtilData* block,
+    NdefParseCtx* ctx)
+{
+    NdefRec* first = NULL;
+    NdefData ndef;
+
+    memset(&ndef, 0, sizeof(ndef));
+    ctx->depth++;
+    if (ctx->opt.max_depth && ctx->depth > ctx->opt.max_depth) {
+        GDEBUG("NDEF nesting is too deep");
+        ctx->result = NDEF_PARSE_LIMIT_DEPTH;
+    } else if (G_LIKELY(block->size)) {
+        GUtilData data = *block;
+        NdefRec* last = NULL;
+        const char* error = NULL;
+
+        while (data.size > 0 && ndef_data_parse(&data, &ndef, &error)) {
+            GASSERT(ndef.rec.size);
+            if (!ndef_rec_filter_match(ctx, &ndef)) {
+                /* Skip it */
+                continue;
+            } else if (!ndef_parse_ctx_check(ctx, &ndef)) {
+                break;
+            } else if (ndef.rec.bytes[0] & NDEF_HDR_CF) {
+                /* Who needs those anyway? */
+                NDEF_WARN("Chunked records are not supported");
+                ndef_reject(block, ndef.rec.bytes - block->bytes,
+                    "Chunked record");
+            } else {
+                NdefRec* rec;
+
+                GDEBUG("NDEF:");
+                ndef_hexdump_data(&ndef.rec);
+                if (ctx->depth == 1 &&
+                    (ctx->opt.flags & NDEF_PARSE_FLAG_PACKED)) {
+                    /* In case if a new slab is needed */
+                    ctx->slab_hint = NDEF_SLAB_HINT(ndef.rec.size +
+                        data.size);
+                }
+                rec = ndef_rec_alloc(&ndef, ctx);
+                if (ctx->result != NDEF_PARSE_OK) {
+                    ndef_rec_unref(rec);
+                    break;
+                } else if (last) {
+                    last->next = rec;
+                    last = rec;
+                } else {
+                    first = last = rec;
+                }
+                if (ndef_rec_filter_done(ctx)) {
+                    break;
+                }
+            }
+        }
+        if (ctx->result != NDEF_PARSE_OK) {
+            ndef_rec_unref(first);
+            first = NULL;
+        } else if (error) {
+            ndef_reject(block, data.bytes - block->bytes, error);
+        }
+    } else if (ndef_rec_filter_match(ctx, &ndef) &&
+        ndef_parse_ctx_check(ctx, &ndef)) {
+        /* Special case - Empty NDEF */
+        GDEBUG("Empty NDEF");
+        first = ndef_rec_alloc(&ndef, ctx);
+    }
+    if (ctx->depth == 1) {
+        /* Records hold their own references to the slabs */
+        ndef_slab_unref(ctx->slab);
+        ctx->slab = NULL;
+        ctx->slab_hint = 0;
+    }
+    ctx->depth--;
+    return first;
+}
+
+/*
+ * Smart Poster content doesn't turn into objects, it's only accounted
+ * for (one level deeper) and then decoded by ndef_rtd_sp_decode().
+ */
 gboolean
-ndef_payload(
-    const NdefData* ndef,
-    GUtilData* payload)
+ndef_parse_ctx_content(
+    NdefParseCtx* ctx,
+    const GUtilData* block)
 {
-    if (ndef && ndef->payload_length) {
-        payload->bytes = ndef->rec.bytes + ndef->type_offset +
-            ndef->type_length + ndef->id_length;
-        payload->size = ndef->payload_length;
+    if (!ctx) {
+        /* Nothing to account for */
         return TRUE;
+    }
+    ctx->depth++;
+    if (ctx->opt.max_depth && ctx->depth > ctx->opt.max_depth) {
+        GDEBUG("NDEF nesting is too deep");
+        ctx->result = NDEF_PARSE_LIMIT_DEPTH;
     } else {
-        payload->bytes = NULL;
-        payload->size = 0;
-        return FALSE;
+        GUtilData data = *block;
+        const char* error = NULL;
+        NdefData ndef;
+
+        while (data.size > 0 && ndef_data_parse(&data, &ndef, &error) &&
+            ndef_parse_ctx_check(ctx, &ndef));
     }
+    ctx->depth--;
+    return ctx->result == NDEF_PARSE_OK;
 }
 
 NdefRec*
@@ -493,38 +945,87 @@ ndef_rec_initialize(
     NdefRec* self,
     NDEF_RTD rtd,
     const NdefData* ndef)
+{
+    ndef_rec_initialize_spare(self, rtd, ndef, 0, NULL);
+    return self;
+}
+
+guint8*
+ndef_rec_initialize_spare(
+    NdefRec* self,
+    NDEF_RTD rtd,
+    const NdefData* ndef,
+    gsize spare,
+    NdefParseCtx* ctx)
 {
     if (self && ndef) {
         NdefRecPriv* priv = self->priv;
-        const GUtilData* rec = &ndef->rec;
-        const guint hdr = rec->bytes[0];
-        const guint8 tnf = (hdr & NDEF_HDR_TNF_MASK);
+        const gsize size = ndef->rec.size;
+        guint8* data = ndef_slab_alloc(ctx, size + spare, &priv->slab);
+        NdefData copy = *ndef;
 
-        if (tnf < NDEF_TNF_MAX) {
-            self->tnf = tnf;
-        }
-        if (hdr & NDEF_HDR_MB) {
-            self->flags |= NDEF_REC_FLAG_FIRST;
-        }
-        if (hdr & NDEF_HDR_ME) {
-            self->flags |= NDEF_REC_FLAG_LAST;
+        if (!data) {
+            data = ndef_rec_buffer(self, size + spare);
         }
-        self->rtd = rtd;
-        self->raw.bytes = priv->data = gutil_memdup(rec->bytes, rec->size);
-        self->raw.size = rec->size;
-        self->type.bytes = self->raw.bytes + ndef->type_offset;
-        self->type.size = ndef->type_length;
-        if (ndef->id_length > 0) {
-            self->id.bytes = self->type.bytes + ndef->type_length;
-            self->id.size = ndef->id_length;
+        memcpy(data, ndef->rec.bytes, size);
+        memset(data + size, 0, spare);
+        copy.rec.bytes = data;
+        if (priv->slab) {
+            ndef_rec_set_data(self, rtd, &copy);
+        } else {
+            ndef_rec_take_data(self, rtd, &copy);
         }
-        if (ndef->payload_length) {
-            self->payload.size = ndef->payload_length;
-            self->payload.bytes = self->type.bytes + ndef->type_length +
-                ndef->id_length;
+        return data + size;
+    }
+    return NULL;
+}
+
+NdefRec*
+ndef_rec_new_with_payload(
+    GType gtype,
+    NDEF_TNF tnf,
+    NDEF_RTD rtd,
+    const GUtilData* type,
+    gsize payload_size,
+    gsize spare,
+    guint8** payload)
+{
+    guint8 head[NDEF_REC_HEADER_MAX];
+    const guint n = ndef_rec_header(head, NDEF_HDR_MB | NDEF_HDR_ME |
+        (tnf & NDEF_HDR_TNF_MASK), type->size, 0, payload_size);
+
+    if (gtype && n) {
+        NdefRec* rec = ndef_rec_object_new(gtype);
+        NdefData ndef;
+        guint8* data;
+
+        /* The final record buffer is allocated (at most) once */
+        memset(&ndef, 0, sizeof(ndef));
+        ndef.rec.size = n + type->size + payload_size;
+        ndef.type_offset = n;
+        ndef.type_length = type->size;
+        ndef.payload_length = payload_size;
+        ndef.rec.bytes = data = ndef_rec_buffer(rec, ndef.rec.size + spare);
+        memcpy(data, head, n);
+        if (type->size) {
+            memcpy(data + n, type->bytes, type->size);
         }
+        memset(data + ndef.rec.size, 0, spare);
+        *payload = data + n + type->size;
+        return ndef_rec_take_data(rec, rtd, &ndef);
     }
-    return self;
+    *payload = NULL;
+    return NULL;
+}
+
+void
+ndef_rec_set_poolable(
+    NdefRec* self)
+{
+    NdefRecPriv* priv = self->priv;
+
+    priv->poolable = TRUE;
+    priv->refs = 1;
 }
 
 void
@@ -533,7 +1034,7 @@ ndef_rec_clear_flags(
     NDEF_REC_FLAGS flags)
 {
     self->flags &= ~flags;
-    self->priv->data[0] &= ~ndef_rec_map_flags(flags);
+    ((guint8*)self->raw.bytes)[0] &= ~ndef_rec_map_flags(flags);
 }
 
 /*==========================================================================*
@@ -545,7 +1046,109 @@ void
 ndef_rec_init(
     NdefRec* self)
 {
-    self->priv = G_TYPE_INSTANCE_GET_PRIVATE(self, THIS_TYPE, NdefRecPriv);
+    self->priv = ndef_rec_get_instance_private(self);
+    self->priv->hash = ndef_rec_compute_hash(self);
+}
+
+/*
+ * Chains are released iteratively. Recursion would run out of stack
+ * on a long enough message (e.g. a few hundred thousand of empty
+ * records). The outermost release on a thread drains the work list,
+ * the nested ones (coming from finalize or clear of the records being
+ * released) only add their next record to it. Whether a record goes
+ * away is decided by unref itself, so a chain shared with someone
+ * else simply stops being released where the shared part begins.
+ */
+typedef struct ndef_rec_release {
+    NdefRec* next;
+    GPtrArray* more;
+} NdefRecRelease;
+
+static GPrivate ndef_rec_release_key;
+
+static
+void
+ndef_rec_release_next(
+    NdefRec* self)
+{
+    NdefRec* next = self->next;
+
+    self->next = NULL;
+    if (next) {
+        NdefRecRelease* active = g_private_get(&ndef_rec_release_key);
+
+        if (!active) {
+            NdefRecRelease release;
+
+            release.next = next;
+            release.more = NULL;
+            g_private_set(&ndef_rec_release_key, &release);
+            for (;;) {
+                NdefRec* rec = release.next;
+
+                if (rec) {
+                    release.next = NULL;
+                } else if (release.more && release.more->len) {
+                    rec = g_ptr_array_remove_index_fast(release.more,
+                        release.more->len - 1);
+                } else {
+                    break;
+                }
+                ndef_rec_unref(rec);
+            }
+            g_private_set(&ndef_rec_release_key, NULL);
+            if (release.more) {
+                g_ptr_array_free(release.more, TRUE);
+            }
+        } else if (!active->next) {
+            active->next = next;
+        } else {
+            /* Unreffing a record has released more than one chain */
+            if (!active->more) {
+                active->more = g_ptr_array_new();
+            }
+            g_ptr_array_add(active->more, next);
+        }
+    }
+}
+
+static
+void
+ndef_rec_clear(
+    NdefRec* self)
+{
+    NdefRecPriv* priv = self->priv;
+
+    ndef_rec_release_next(self);
+    ndef_slab_unref(priv->slab);
+    priv->slab = NULL;
+    if (priv->alloc > NDEF_REC_POOL_MAX_BUF) {
+        g_free(priv->data);
+        priv->data = NULL;
+        priv->alloc = 0;
+    }
+    self->tnf = NDEF_TNF_EMPTY;
+    self->rtd = NDEF_RTD_UNKNOWN;
+    self->flags = NDEF_REC_FLAGS_NONE;
+    memset(&self->raw, 0, sizeof(self->raw));
+    memset(&self->type, 0, sizeof(self->type));
+    memset(&self->id, 0, sizeof(self->id));
+    memset(&self->payload, 0, sizeof(self->payload));
+    priv->hash = ndef_rec_compute_hash(self);
+}
+
+static
+NdefRec*
+ndef_rec_dup(
+    NdefRec* rec,
+    const NdefData* ndef,
+    NdefParseCtx* ctx)
+{
+    NdefRec* self = ndef_rec_object_new(THIS_TYPE);
+
+    /* Nothing to decode */
+    ndef_rec_initialize_spare(self, rec->rtd, ndef, 0, ctx);
+    return self;
 }
 
 static
@@ -556,8 +1159,9 @@ ndef_rec_finalize(
     NdefRec* self = THIS(object);
     NdefRecPriv* priv = self->priv;
 
+    ndef_rec_release_next(self);
+    ndef_slab_unref(priv->slab);
     g_free(priv->data);
-    ndef_rec_unref(self->next);
     G_OBJECT_CLASS(PARENT_CLASS)->finalize(object);
 }
 
@@ -566,8 +1170,9 @@ void
 ndef_rec_class_init(
     NdefRecClass* klass)
 {
-    g_type_class_add_private(klass, sizeof(NdefRecPriv));
     G_OBJECT_CLASS(klass)->finalize = ndef_rec_finalize;
+    klass->clear = ndef_rec_clear;
+    klass->dup = ndef_rec_dup;
 }
 
 /*
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "ndef_rec_p.h"
+
+/*
+ * Load balancing is dynamic. Each thread (including the calling one)
+ * keeps grabbing the next chunk of inputs by atomically advancing the
+ * shared index, so the threads which happen to get cheap inputs end up
+ * processing more of them. Each thread writes only its own slots of
+ * the result arrays, which keeps the results in order. Each thread has
+ * its own parser context.
+ */
+
+/* Number of chunks per thread, more chunks balance better */
+#define NDEF_REC_BATCH_CHUNKS (8)
+
+/*
+ * The shared index is a gint and each thread overshoots the count by
+ * up to a chunk when it runs out of work. Half of the gint range leaves
+ * enough room for that.
+ */
+#define NDEF_REC_BATCH_MAX (G_MAXINT / 2)
+
+typedef struct ndef_rec_batch {
+    const GUtilData* inputs;
+    guint count;
+    guint chunk;
+    gboolean tlv;
+    const NdefParseOpt* opt;
+    NdefRec** results;
+    NDEF_PARSE_RESULT* status;
+    gint next;
+    gint parsed;
+} NdefRecBatch;
+
+static
+gpointer
+ndef_rec_batch_run(
+    gpointer data)
+{
+    NdefRecBatch* batch = data;
+    NdefParser* parser = ndef_parser_new(batch->opt);
+    guint parsed = 0;
+    guint i;
+
+    while ((i = (guint) g_atomic_int_add(&batch->next, batch->chunk)) <
+        batch->count) {
+        const guint end = MIN(i + batch->chunk, batch->count);
+
+        for (; i < end; i++) {
+            NDEF_PARSE_RESULT result;
+            NdefRec* rec = batch->tlv ?
+                ndef_parser_parse_tlv(parser, batch->inputs + i, &result) :
+                ndef_parser_parse(parser, batch->inputs + i, &result);
+
+            batch->results[i] = rec;
+            if (batch->status) {
+                batch->status[i] = result;
+            }
+            if (rec) {
+                parsed++;
+            }
+        }
+    }
+    g_atomic_int_add(&batch->parsed, parsed);
+    ndef_parser_free(parser);
+    return NULL;
+}
+
+/*==========================================================================*
+ * Interface
+ *==========================================================================*/
+
+guint
+ndef_rec_new_batch(
+    const GUtilData* inputs,
+    guint count,
+    gboolean tlv,
+    const NdefParseOpt* opt,
+    guint threads,
+    NdefRec** results,
+    NDEF_PARSE_RESULT* status)
+{
+    if (G_LIKELY(inputs) && G_LIKELY(results) && count &&
+        G_LIKELY(count <= NDEF_REC_BATCH_MAX)) {
+        GThread** workers;
+        NdefRecBatch batch;
+        guint i;
+
+        if (!threads) {
+            threads = g_get_num_processors();
+        }
+        threads = MIN(threads, count);
+
+        memset(&batch, 0, sizeof(batch));
+        batch.inputs = inputs;
+        batch.count = count;
+        batch.chunk = MAX(count / (threads * NDEF_REC_BATCH_CHUNKS), 1);
+        batch.tlv = tlv;
+        batch.opt = opt;
+        batch.results = results;
+        batch.status = status;
+
+        /* The calling thread is one of the workers */
+        workers = g_new(GThread*, threads - 1);
+        for (i = 0; i < threads - 1; i++) {
+            workers[i] = g_thread_new("ndef-batch", ndef_rec_batch_run,
+                &batch);
+        }
+        ndef_rec_batch_run(&batch);
+        for (i = 0; i < threads - 1; i++) {
+            g_thread_join(workers[i]);
+        }
+        g_free(workers);
+        return (guint) batch.parsed;
+    }
+    return 0;
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
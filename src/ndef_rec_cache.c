@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "ndef_rec_p.h"
+#include "ndef_util_p.h"
+
+/*
+ * LRU cache of parse results. The key is the input data (and the parse
+ * function, since the same bytes mean different things as TLV and as
+ * NDEF), looked up by its hash and then compared byte by byte. Each
+ * entry holds a reference to the first record of the parsed chain and
+ * sits in the LRU list, most recently used first. The records are
+ * released outside of the lock.
+ */
+
+typedef struct ndef_rec_cache_entry {
+    GList link; /* data points back to the entry */
+    NdefRecParseFunc parse;
+    NdefRec* rec;
+    const guint8* bytes;
+    gsize size;
+    guint hash;
+    /* Followed by the copy of the input data */
+} NdefRecCacheEntry;
+
+static GHashTable* ndef_rec_cache_table = NULL;
+static GQueue ndef_rec_cache_lru = G_QUEUE_INIT;
+static gint ndef_rec_cache_max_size = 0;
+
+G_LOCK_DEFINE_STATIC(ndef_rec_cache);
+
+static
+guint
+ndef_rec_cache_entry_hash(
+    gconstpointer key)
+{
+    return ((const NdefRecCacheEntry*)key)->hash;
+}
+
+static
+gboolean
+ndef_rec_cache_entry_equal(
+    gconstpointer a,
+    gconstpointer b)
+{
+    const NdefRecCacheEntry* e1 = a;
+    const NdefRecCacheEntry* e2 = b;
+
+    return e1->parse == e2->parse && e1->size == e2->size &&
+        !memcmp(e1->bytes, e2->bytes, e1->size);
+}
+
+/* Must be called under the lock, returns the evicted entries */
+static
+GList*
+ndef_rec_cache_shrink(
+    guint max_size)
+{
+    GList* evicted = NULL;
+
+    while (ndef_rec_cache_lru.length > max_size) {
+        GList* link = g_queue_pop_tail_link(&ndef_rec_cache_lru);
+
+        g_hash_table_remove(ndef_rec_cache_table, link->data);
+        link->next = evicted;
+        evicted = link;
+    }
+    return evicted;
+}
+
+static
+void
+ndef_rec_cache_free(
+    GList* evicted)
+{
+    while (evicted) {
+        NdefRecCacheEntry* entry = evicted->data;
+
+        evicted = evicted->next;
+        ndef_rec_unref(entry->rec);
+        g_free(entry);
+    }
+}
+
+static
+void
+ndef_rec_cache_add(
+    const NdefRecCacheEntry* key,
+    NdefRec* rec)
+{
+    GList* evicted = NULL;
+
+    G_LOCK(ndef_rec_cache);
+    /* Another thread may have added the same data in the meantime */
+    if (ndef_rec_cache_table &&
+        !g_hash_table_contains(ndef_rec_cache_table, key)) {
+        NdefRecCacheEntry* entry = g_malloc(sizeof(*entry) + key->size);
+        guint8* bytes = (guint8*)(entry + 1);
+
+        memset(&entry->link, 0, sizeof(entry->link));
+        entry->link.data = entry;
+        entry->parse = key->parse;
+        entry->rec = ndef_rec_ref(rec);
+        entry->bytes = bytes;
+        entry->size = key->size;
+        entry->hash = key->hash;
+        memcpy(bytes, key->bytes, key->size);
+        g_hash_table_add(ndef_rec_cache_table, entry);
+        g_queue_push_head_link(&ndef_rec_cache_lru, &entry->link);
+        evicted = ndef_rec_cache_shrink(ndef_rec_cache_max_size);
+    }
+    G_UNLOCK(ndef_rec_cache);
+    ndef_rec_cache_free(evicted);
+}
+
+/*==========================================================================*
+ * Interface
+ *==========================================================================*/
+
+void
+ndef_rec_cache_set_max_size(
+    guint max_size)
+{
+    GList* evicted;
+
+    max_size = MIN(max_size, G_MAXINT);
+    G_LOCK(ndef_rec_cache);
+    if (max_size && !ndef_rec_cache_table) {
+        ndef_rec_cache_table = g_hash_table_new(ndef_rec_cache_entry_hash,
+            ndef_rec_cache_entry_equal);
+    }
+    g_atomic_int_set(&ndef_rec_cache_max_size, max_size);
+    evicted = ndef_rec_cache_table ? ndef_rec_cache_shrink(max_size) : NULL;
+    if (!max_size && ndef_rec_cache_table) {
+        g_hash_table_destroy(ndef_rec_cache_table);
+        ndef_rec_cache_table = NULL;
+    }
+    G_UNLOCK(ndef_rec_cache);
+    ndef_rec_cache_free(evicted);
+}
+
+void
+ndef_rec_cache_clear(
+    void)
+{
+    GList* evicted = NULL;
+
+    G_LOCK(ndef_rec_cache);
+    if (ndef_rec_cache_table) {
+        evicted = ndef_rec_cache_shrink(0);
+    }
+    G_UNLOCK(ndef_rec_cache);
+    ndef_rec_cache_free(evicted);
+}
+
+/*==========================================================================*
+ * Internal interface
+ *==========================================================================*/
+
+NdefRec*
+ndef_rec_cache_parse(
+    const GUtilData* data,
+    NdefRecParseFunc parse)
+{
+    /* Don't even calculate the hash if the cache is disabled */
+    if (G_LIKELY(data) && g_atomic_int_get(&ndef_rec_cache_max_size)) {
+        NdefRecCacheEntry key;
+        NdefRecCacheEntry* entry;
+        NdefRec* rec = NULL;
+
+        key.parse = parse;
+        key.bytes = data->bytes;
+        key.size = data->size;
+        key.hash = ndef_hash_data(NDEF_HASH_INIT, data);
+
+        G_LOCK(ndef_rec_cache);
+        entry = ndef_rec_cache_table ?
+            g_hash_table_lookup(ndef_rec_cache_table, &key) : NULL;
+        if (entry) {
+            /* Move it to the head of the list */
+            g_queue_unlink(&ndef_rec_cache_lru, &entry->link);
+            g_queue_push_head_link(&ndef_rec_cache_lru, &entry->link);
+            rec = ndef_rec_ref(entry->rec);
+        }
+        G_UNLOCK(ndef_rec_cache);
+
+        if (!rec) {
+            rec = parse(data, NULL, NULL);
+            if (rec) {
+                ndef_rec_cache_add(&key, rec);
+            }
+        }
+        return rec;
+    }
+    return parse(data, NULL, NULL);
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -42,42 +42,74 @@
 #define NDEF_REC_PRIVATE_H
 
 #include "ndef_types.h"
+#include "ndef_msg.h"
 #include "ndef_rec.h"
+#include "ndef_util_p.h"
+
+typedef struct ndef_slab NdefSlab;
+
+/* Parsing state shared by nested parsers */
+typedef struct ndef_parse_ctx {
+    NdefParseOpt opt;
+    NDEF_PARSE_RESULT result;
+    guint records;
+    gsize bytes;
+    guint depth;
+    gint64 deadline;
+    const NdefRecFilter* filter;
+    guint matches;
+    NdefSlab* slab;
+    gsize slab_hint;
+    NdefScratch* scratch;
+} NdefParseCtx;
 
 typedef struct ndef_rec_class {
     GObjectClass parent;
+    /* Releases the contents but keeps the record buffer for reuse */
+    void (*clear)(NdefRec* rec);
+    /*
+     * Creates a record from the same bytes as rec (ndef) reusing what
+     * has already been decoded. Returns NULL if that's not possible.
+     */
+    NdefRec* (*dup)(NdefRec* rec, const NdefData* ndef, NdefParseCtx* ctx);
 } NdefRecClass;
 
-/* Pre-parsed NDEF record */
-typedef struct ndef_data {
-    GUtilData rec;
-    guint type_offset;
-    guint type_length;
-    guint id_length;
-    guint payload_length;
-} NdefData;
-
-#define NDEF_HDR_MB       (0x80)
-#define NDEF_HDR_ME       (0x40)
-#define NDEF_HDR_CF       (0x20)
-#define NDEF_HDR_SR       (0x10)
-#define NDEF_HDR_IL       (0x08)
-#define NDEF_HDR_TNF_MASK (0x07)
-
-extern const GUtilData ndef_rec_type_u G_GNUC_INTERNAL; /* "U" */
-extern const GUtilData ndef_rec_type_t G_GNUC_INTERNAL; /* "T" */
-extern const GUtilData ndef_rec_type_sp G_GNUC_INTERNAL; /* "Sp" */
+#define NDEF_REC_GET_CLASS(obj) G_TYPE_INSTANCE_GET_CLASS(obj, \
+        NDEF_TYPE_REC, NdefRecClass)
 
-gboolean
-ndef_type(
-    const NdefData* data,
-    GUtilData* type)
+void
+ndef_parse_ctx_init(
+    NdefParseCtx* ctx,
+    const NdefParseOpt* opt)
     G_GNUC_INTERNAL;
 
+/* ctx may be NULL, so may be the one passed to the constructors below */
 gboolean
-ndef_payload(
-    const NdefData* data,
-    GUtilData* payload)
+ndef_parse_ctx_content(
+    NdefParseCtx* ctx,
+    const GUtilData* block)
+    G_GNUC_INTERNAL;
+
+NdefRec*
+ndef_rec_parse_message(
+    const GUtilData* block,
+    NdefParseCtx* ctx)
+    G_GNUC_INTERNAL;
+
+NdefRec*
+ndef_rec_parse_block(
+    const GUtilData* block,
+    const NdefParseOpt* opt,
+    NdefScratch* scratch,
+    NDEF_PARSE_RESULT* result)
+    G_GNUC_INTERNAL;
+
+NdefRec*
+ndef_rec_parse_tlv(
+    const GUtilData* tlv,
+    const NdefParseOpt* opt,
+    NdefScratch* scratch,
+    NDEF_PARSE_RESULT* result)
     G_GNUC_INTERNAL;
 
 NdefRec*
@@ -87,6 +119,20 @@ ndef_rec_initialize(
     const NdefData* ndef)
     G_GNUC_INTERNAL;
 
+/*
+ * Returns the zero-filled spare bytes following the raw record. If ctx
+ * is provided, the record may end up in the slab shared by the records
+ * of the message being parsed.
+ */
+guint8*
+ndef_rec_initialize_spare(
+    NdefRec* rec,
+    NDEF_RTD rtd,
+    const NdefData* ndef,
+    gsize spare,
+    NdefParseCtx* ctx)
+    G_GNUC_INTERNAL;
+
 void
 ndef_rec_clear_flags(
     NdefRec* rec,
@@ -101,9 +147,60 @@ ndef_rec_new_well_known(
     const GUtilData* payload)
     G_GNUC_INTERNAL;
 
+typedef
+NdefRec*
+(*NdefRecParseFunc)(
+    const GUtilData* data,
+    const NdefParseOpt* opt,
+    NDEF_PARSE_RESULT* result);
+
+/* Looks up the result in the cache, calls the parser on a miss */
+NdefRec*
+ndef_rec_cache_parse(
+    const GUtilData* data,
+    NdefRecParseFunc parse)
+    G_GNUC_INTERNAL;
+
+/* Reuses a pooled instance if there is one */
+NdefRec*
+ndef_rec_object_new(
+    GType type)
+    G_GNUC_INTERNAL;
+
+/*
+ * Called by ndef_rec_unref() when the last reference to a poolable
+ * record is gone. Returns TRUE if the record has been recycled.
+ */
+gboolean
+ndef_rec_pool_put(
+    NdefRec* rec)
+    G_GNUC_INTERNAL;
+
+/* Makes ndef_rec_ref/unref count the references (starting with one) */
+void
+ndef_rec_set_poolable(
+    NdefRec* rec)
+    G_GNUC_INTERNAL;
+
+/*
+ * Allocates the record buffer once, with payload_size bytes of payload
+ * followed by zero-filled spare bytes. The caller fills the payload.
+ */
+NdefRec*
+ndef_rec_new_with_payload(
+    GType gtype,
+    NDEF_TNF tnf,
+    NDEF_RTD rtd,
+    const GUtilData* type,
+    gsize payload_size,
+    gsize spare,
+    guint8** payload)
+    G_GNUC_INTERNAL;
+
 NdefRecU*
 ndef_rec_u_new_from_data(
-    const NdefData* ndef)
+    const NdefData* ndef,
+    NdefParseCtx* ctx)
     G_GNUC_INTERNAL;
 
 char*
@@ -113,7 +210,8 @@ ndef_rec_u_steal_uri(
 
 NdefRecT*
 ndef_rec_t_new_from_data(
-    const NdefData* ndef)
+    const NdefData* ndef,
+    NdefParseCtx* ctx)
     G_GNUC_INTERNAL;
 
 char*
@@ -128,7 +226,8 @@ ndef_rec_t_steal_text(
 
 NdefRecSp*
 ndef_rec_sp_new_from_data(
-    const NdefData* ndef)
+    const NdefData* ndef,
+    NdefParseCtx* ctx)
     G_GNUC_INTERNAL;
 
 #endif /* NDEF_REC_PRIVATE_H */
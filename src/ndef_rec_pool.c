@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "ndef_rec_p.h"
+
+/*
+ * The pool is per-thread and therefore lock-free. Pooled records are
+ * linked through their next pointers. Each kind of record has its own
+ * list. Trimming releases the records which have stayed unused since
+ * the previous trim, i.e. the smallest size the list has had since
+ * then (the low watermark).
+ *
+ * Only the records created while the pool is enabled can be recycled.
+ * Their references are counted by ndef_rec_ref() and ndef_rec_unref()
+ * rather than by GObject, so the decision to recycle is made by the
+ * atomic decrement of that count.
+ */
+
+typedef enum ndef_rec_pool_kind {
+    NDEF_REC_POOL_GENERIC,
+    NDEF_REC_POOL_URI,
+    NDEF_REC_POOL_TEXT,
+    NDEF_REC_POOL_SP,
+    NDEF_REC_POOL_KINDS
+} NDEF_REC_POOL_KIND;
+
+typedef struct ndef_rec_pool_list {
+    NdefRec* first;
+    guint count;
+    guint low;
+} NdefRecPoolList;
+
+typedef struct ndef_rec_pool {
+    guint max_size;
+    guint count;
+    NdefRecPoolList list[NDEF_REC_POOL_KINDS];
+} NdefRecPool;
+
+static
+void
+ndef_rec_pool_list_release(
+    NdefRecPoolList* list,
+    guint n)
+{
+    while (n-- > 0 && list->first) {
+        NdefRec* rec = list->first;
+
+        list->first = rec->next;
+        list->count--;
+        rec->next = NULL;
+        g_object_unref(rec);
+    }
+    if (list->low > list->count) {
+        list->low = list->count;
+    }
+}
+
+static
+void
+ndef_rec_pool_free(
+    gpointer data)
+{
+    NdefRecPool* pool = data;
+    guint i;
+
+    for (i = 0; i < NDEF_REC_POOL_KINDS; i++) {
+        NdefRecPoolList* list = pool->list + i;
+
+        ndef_rec_pool_list_release(list, list->count);
+    }
+    g_free(pool);
+}
+
+static GPrivate ndef_rec_pool_key = G_PRIVATE_INIT(ndef_rec_pool_free);
+
+static
+gboolean
+ndef_rec_pool_kind(
+    GType type,
+    NDEF_REC_POOL_KIND* kind)
+{
+    if (type == NDEF_TYPE_REC) {
+        *kind = NDEF_REC_POOL_GENERIC;
+    } else if (type == NDEF_TYPE_REC_U) {
+        *kind = NDEF_REC_POOL_URI;
+    } else if (type == NDEF_TYPE_REC_T) {
+        *kind = NDEF_REC_POOL_TEXT;
+    } else if (type == NDEF_TYPE_REC_SP) {
+        *kind = NDEF_REC_POOL_SP;
+    } else {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*==========================================================================*
+ * Interface
+ *==========================================================================*/
+
+void
+ndef_rec_pool_set_max_size(
+    guint max_size)
+{
+    NdefRecPool* pool = g_private_get(&ndef_rec_pool_key);
+
+    if (max_size) {
+        if (!pool) {
+            pool = g_new0(NdefRecPool, 1);
+            g_private_set(&ndef_rec_pool_key, pool);
+        }
+        pool->max_size = max_size;
+        if (pool->count > max_size) {
+            guint excess = pool->count - max_size;
+            guint i;
+
+            for (i = 0; i < NDEF_REC_POOL_KINDS && excess; i++) {
+                NdefRecPoolList* list = pool->list + i;
+                const guint n = MIN(list->count, excess);
+
+                ndef_rec_pool_list_release(list, n);
+                pool->count -= n;
+                excess -= n;
+            }
+        }
+    } else if (pool) {
+        /* This frees the pool */
+        g_private_replace(&ndef_rec_pool_key, NULL);
+    }
+}
+
+void
+ndef_rec_pool_trim(
+    void)
+{
+    NdefRecPool* pool = g_private_get(&ndef_rec_pool_key);
+
+    if (pool) {
+        guint i;
+
+        for (i = 0; i < NDEF_REC_POOL_KINDS; i++) {
+            NdefRecPoolList* list = pool->list + i;
+            const guint n = list->low;
+
+            ndef_rec_pool_list_release(list, n);
+            pool->count -= n;
+            list->low = list->count;
+        }
+    }
+}
+
+/*==========================================================================*
+ * Internal interface
+ *==========================================================================*/
+
+NdefRec*
+ndef_rec_object_new(
+    GType type)
+{
+    NdefRecPool* pool = g_private_get(&ndef_rec_pool_key);
+    NDEF_REC_POOL_KIND kind;
+
+    if (pool && ndef_rec_pool_kind(type, &kind)) {
+        NdefRecPoolList* list = pool->list + kind;
+        NdefRec* rec = list->first;
+
+        if (rec) {
+            list->first = rec->next;
+            rec->next = NULL;
+            pool->count--;
+            if (--(list->count) < list->low) {
+                list->low = list->count;
+            }
+        } else {
+            rec = g_object_new(type, NULL);
+        }
+        ndef_rec_set_poolable(rec);
+        return rec;
+    }
+    return g_object_new(type, NULL);
+}
+
+gboolean
+ndef_rec_pool_put(
+    NdefRec* rec)
+{
+    NdefRecPool* pool = g_private_get(&ndef_rec_pool_key);
+    NDEF_REC_POOL_KIND kind;
+
+    if (pool && pool->count < pool->max_size &&
+        ndef_rec_pool_kind(G_OBJECT_TYPE(rec), &kind)) {
+        /* This may pool the rest of the chain */
+        NDEF_REC_GET_CLASS(rec)->clear(rec);
+        if (pool->count < pool->max_size) {
+            NdefRecPoolList* list = pool->list + kind;
+
+            rec->next = list->first;
+            list->first = rec;
+            list->count++;
+            pool->count++;
+        } else {
+            g_object_unref(rec);
+        }
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -39,15 +39,13 @@
 
 #include "ndef_rec_p.h"
 #include "ndef_util_p.h"
-#include "ndef_log.h"
 
 #include <gutil_misc.h>
 
 /* NFCForum-TS-RTD_TEXT_1.0 */
 
 struct nfc_ndef_rec_t_priv {
-    char* lang;
-    char* text;
+    NdefRtdText* data;
 };
 
 #define THIS(obj) NDEF_REC_T(obj)
@@ -56,75 +54,17 @@ struct nfc_ndef_rec_t_priv {
 #define PARENT_CLASS ndef_rec_t_parent_class
 
 typedef NdefRecClass NdefRecTClass;
-G_DEFINE_TYPE(NdefRecT, ndef_rec_t, PARENT_TYPE)
-
-const GUtilData ndef_rec_type_t = { (const guint8*) "T", 1 };
-
-#define STATUS_LANG_LEN_MASK (0x3f)
-#define STATUS_ENC_UTF16 (0x80) /* Otherwise UTF-8 */
-
-static const char ENC_UTF8[] = "UTF-8";
-static const char ENC_UTF16_LE[] = "UTF-16LE";
-static const char ENC_UTF16_BE[] = "UTF-16BE";
-
-/* UTF-16 Byte Order Marks */
-static const guint8 UTF16_BOM_LE[] = {0xff, 0xfe};
-static const guint8 UTF16_BOM_BE[] = {0xfe, 0xff};
+G_DEFINE_TYPE_WITH_PRIVATE(NdefRecT, ndef_rec_t, PARENT_TYPE)
 
 static
-GBytes*
-ndef_rec_t_build(
-    const char* text,
-    const char* lang,
-    NDEF_REC_T_ENC enc)
+void
+ndef_rec_t_set_data(
+    NdefRecT* self,
+    NdefRtdText* data)
 {
-    const guint8 lang_len = strlen(lang);
-    const gsize text_len = strlen(text);
-    const guint8 status_byte = (lang_len & STATUS_LANG_LEN_MASK) |
-        ((enc == NDEF_REC_T_ENC_UTF8) ? 0 : STATUS_ENC_UTF16);
-    const guint8* bom = NULL;
-    const void* enc_text = NULL;
-    void* enc_text_tmp = NULL;
-    gsize enc_text_len;
-    gsize bom_len = 0;
-    GError* err = NULL;
-
-    switch (enc) {
-    case NDEF_REC_T_ENC_UTF8:
-        enc_text = text;
-        enc_text_len = text_len;
-        break;
-    case NDEF_REC_T_ENC_UTF16BE:
-         enc_text = enc_text_tmp = g_convert(text, text_len, ENC_UTF16_BE,
-            ENC_UTF8, NULL, &enc_text_len, &err);
-         break;
-    case NDEF_REC_T_ENC_UTF16LE:
-        bom = UTF16_BOM_LE;
-        bom_len = sizeof(UTF16_BOM_LE);
-        enc_text = enc_text_tmp = g_convert(text, text_len, ENC_UTF16_LE,
-            ENC_UTF8, NULL, &enc_text_len, &err);
-        break;
-    }
-
-    if (enc_text) {
-        GByteArray* buf = g_byte_array_sized_new(1 + lang_len + bom_len +
-            enc_text_len);
-
-        g_byte_array_append(buf, &status_byte, 1);
-        g_byte_array_append(buf, (const guint8*)lang, lang_len);
-        if (bom) g_byte_array_append(buf, bom, bom_len);
-        g_byte_array_append(buf, enc_text, enc_text_len);
-        g_free(enc_text_tmp);
-        return g_byte_array_free_to_bytes(buf);
-    } else {
-        if (err) {
-            GWARN("Failed to encode Text record: %s", err->message);
-            g_error_free(err);
-        } else {
-            GWARN("Failed to encode Text record");
-        }
-        return NULL;
-    }
+    self->priv->data = data;
+    self->lang = data->lang;
+    self->text = data->text;
 }
 
 /*==========================================================================*
@@ -133,75 +73,43 @@ ndef_rec_t_build(
 
 NdefRecT*
 ndef_rec_t_new_from_data(
-    const NdefData* ndef)
+    const NdefData* ndef,
+    NdefParseCtx* ctx)
 {
-    GUtilData payload;
-
-    if (ndef_payload(ndef, &payload)) {
-        const guint8 status_byte = payload.bytes[0];
-        const guint lang_len = (status_byte & STATUS_LANG_LEN_MASK);
-        const char* lang = (char*)payload.bytes + 1;
-
-        if ((lang_len < payload.size) && /* Empty or ASCII (at least UTF-8) */
-            (!lang_len || g_utf8_validate(lang, lang_len, NULL))) {
-            const char* text = (char*)payload.bytes + lang_len + 1;
-            const guint text_len = payload.size - lang_len - 1;
-            const char* utf8;
-            gsize utf8_len;
-            char* utf8_buf;
-
-            if (status_byte & STATUS_ENC_UTF16) {
-                GError* err = NULL;
-                if (text_len >= sizeof(UTF16_BOM_BE) &&
-                    !memcmp(text, UTF16_BOM_BE, sizeof(UTF16_BOM_BE))) {
-                    utf8_buf = g_convert(text + sizeof(UTF16_BOM_BE),
-                        text_len - sizeof(UTF16_BOM_BE), ENC_UTF8,
-                        ENC_UTF16_BE, NULL, &utf8_len, &err);
-                } else if (text_len >= sizeof(UTF16_BOM_LE) &&
-                    !memcmp(text, UTF16_BOM_LE, sizeof(UTF16_BOM_LE))) {
-                    utf8_buf = g_convert(text + sizeof(UTF16_BOM_LE),
-                        text_len - sizeof(UTF16_BOM_LE), ENC_UTF8,
-                        ENC_UTF16_LE, NULL, &utf8_len, &err);
-                } else {
-                    /*
-                     * 3.4 UTF-16 Byte Order
-                     *
-                     * ... If the BOM is omitted, the byte order shall be
-                     * big-endian (UTF-16 BE).
-                     */
-                    utf8_buf = g_convert(text, text_len, ENC_UTF8,
-                        ENC_UTF16_BE, NULL, &utf8_len, &err);
-                }
-                if (err) {
-                    GWARN("Failed to decode Text record: %s", err->message);
-                    g_free(utf8_buf); /* Should be NULL already */
-                    g_error_free(err);
-                    utf8 = NULL;
-                } else {
-                    utf8 = utf8_buf;
-                }
-            } else if (!text_len) {
-                utf8 = "";
-                utf8_buf = NULL;
-            } else if (g_utf8_validate(text, text_len, NULL)) {
-                utf8 = utf8_buf = g_strndup(text, text_len);
-                utf8_len = text_len;
-            } else {
-                utf8 = NULL;
-            }
+    GUtilData payload, lang, text;
+    NDEF_REC_T_ENC enc;
+
+    if (ndef_payload(ndef, &payload) &&
+        ndef_rtd_text_parse(&payload, &lang, &text, &enc)) {
+        if (enc == NDEF_REC_T_ENC_UTF8) {
+            NdefRecT* self = THIS(ndef_rec_object_new(THIS_TYPE));
+            NdefRec* rec = &self->rec;
+            const char* tag = ndef_intern(&lang);
+            char* spare;
+
+            /*
+             * UTF-8 strings point into the record itself. The text is
+             * at the very end of the record and gets terminated by the
+             * first spare byte. The language tag is interned or, if
+             * that fails, copied after the terminator.
+             */
+            spare = (char*) ndef_rec_initialize_spare(rec, NDEF_RTD_TEXT,
+                ndef, tag ? 1 : (lang.size + 2), ctx);
+            self->lang = tag ? tag : memcpy(spare + 1, lang.bytes,
+                lang.size);
+            self->text = (const char*) rec->payload.bytes +
+                (text.bytes - payload.bytes);
+            return self;
+        } else {
+            NdefRtdText* data = ndef_rtd_text_decode_scratch(&payload,
+                ctx ? ctx->scratch : NULL);
+
+            if (data) {
+                NdefRecT* self = THIS(ndef_rec_object_new(THIS_TYPE));
 
-            if (utf8) {
-                NdefRecT* self = g_object_new(THIS_TYPE, NULL);
-                NdefRecTPriv* priv = self->priv;
-
-                ndef_rec_initialize(&self->rec, NDEF_RTD_TEXT, ndef);
-                self->text = utf8;
-                priv->text = utf8_buf;
-                if (lang_len) {
-                    self->lang = priv->lang = g_strndup(lang, lang_len);
-                } else {
-                    self->lang = "";
-                }
+                ndef_rec_initialize_spare(&self->rec, NDEF_RTD_TEXT, ndef,
+                    0, ctx);
+                ndef_rec_t_set_data(self, data);
                 return self;
             }
         }
@@ -215,47 +123,58 @@ ndef_rec_t_new_enc(
     const char* lang,
     NDEF_REC_T_ENC enc)
 {
-    GBytes* payload_bytes;
     char* lang_tmp = NULL;
-    static const char lang_default[] = "en";
-    static const char text_default[] = "";
+    NdefRecT* self = NULL;
+    gsize lang_len;
 
     if (!lang) {
-        NdefLanguage* system = ndef_system_language();
-
-        if (system) {
-            lang = lang_tmp = system->territory ?
-                g_strconcat(system->language, "-", system->territory, NULL) :
-                g_strdup(system->language);
-            g_free(system);
-            GDEBUG("System language: %s", lang);
-        }
+        lang = lang_tmp = ndef_default_lang_tag();
+    }
+    if (!text) {
+        text = "";
     }
 
-    payload_bytes = ndef_rec_t_build(text ? text : text_default,
-        lang ? lang : lang_default, enc);
-    if (payload_bytes) {
-        GUtilData payload;
-        NdefRecT* self = THIS(ndef_rec_new_well_known(THIS_TYPE, NDEF_RTD_TEXT,
-            &ndef_rec_type_t, gutil_data_from_bytes(&payload, payload_bytes)));
-        NdefRecTPriv* priv = self->priv;
-
-        /* Avoid unnecessary allocations */
-        if (lang) {
-            self->lang = priv->lang = (lang_tmp ? lang_tmp : g_strdup(lang));
-        } else {
-            self->lang = lang_default;
+    lang_len = strlen(lang);
+
+    if (enc == NDEF_REC_T_ENC_UTF8 && lang_len <= NDEF_TEXT_LANG_MAX) {
+        const gsize text_len = strlen(text);
+        GUtilData lang_data;
+        const char* tag = ndef_intern(gutil_data_from_string(&lang_data,
+            lang));
+        guint8* payload;
+        NdefRec* rec = ndef_rec_new_with_payload(THIS_TYPE,
+            NDEF_TNF_WELL_KNOWN, NDEF_RTD_TEXT, &ndef_rec_type_t,
+            1 + lang_len + text_len, tag ? 1 : (lang_len + 2), &payload);
+
+        /* Same layout as what ndef_rec_t_new_from_data() produces */
+        if (rec) {
+            char* spare = (char*) payload + 1 + lang_len + text_len;
+
+            self = THIS(rec);
+            payload[0] = (guint8) lang_len; /* Status byte */
+            memcpy(payload + 1, lang, lang_len);
+            memcpy(payload + 1 + lang_len, text, text_len);
+            self->lang = tag ? tag : memcpy(spare + 1, lang, lang_len);
+            self->text = (const char*) payload + 1 + lang_len;
         }
-        if (text) {
-            self->text = priv->text = g_strdup(text);
-        } else {
-            self->text = text_default;
+    } else {
+        GBytes* payload_bytes = ndef_rtd_text_encode(text, lang, enc);
+
+        if (payload_bytes) {
+            GUtilData payload;
+
+            self = THIS(ndef_rec_new_well_known(THIS_TYPE, NDEF_RTD_TEXT,
+                &ndef_rec_type_t, gutil_data_from_bytes(&payload,
+                payload_bytes)));
+            if (self) {
+                ndef_rec_t_set_data(self, ndef_rtd_text_new(text, lang,
+                    enc));
+            }
+            g_bytes_unref(payload_bytes);
         }
-        g_bytes_unref(payload_bytes);
-        return self;
     }
     g_free(lang_tmp);
-    return NULL;
+    return self;
 }
 
 NDEF_LANG_MATCH
@@ -263,29 +182,8 @@ ndef_rec_t_lang_match(
     NdefRecT* rec,
     const NdefLanguage* lang)
 {
-    NDEF_LANG_MATCH match = NDEF_LANG_MATCH_NONE;
-
-    if (G_LIKELY(rec) && G_LIKELY(lang) && G_LIKELY(lang->language)) {
-        const char* sep = strchr(rec->lang, '-');
-
-        if (sep) {
-            const gsize lang_len = sep - rec->lang;
-
-            if (strlen(lang->language) == lang_len &&
-                !g_ascii_strncasecmp(rec->lang, lang->language, lang_len)) {
-                match |= NDEF_LANG_MATCH_LANGUAGE;
-            }
-            if (lang->territory && lang->territory[0] &&
-                !g_ascii_strcasecmp(sep + 1, lang->territory)) {
-                match |= NDEF_LANG_MATCH_TERRITORY;
-            }
-        } else {
-            if (!g_ascii_strcasecmp(rec->lang, lang->language)) {
-                match |= NDEF_LANG_MATCH_LANGUAGE;
-            }
-        }
-    }
-    return match;
+    return G_LIKELY(rec) ? ndef_rtd_lang_match(rec->lang, lang) :
+        NDEF_LANG_MATCH_NONE;
 }
 
 gint
@@ -326,17 +224,17 @@ ndef_rec_t_lang_compare(
     }
 }
 
+/* The strings may point into the record, these return copies */
+
 char*
 ndef_rec_t_steal_lang(
     NdefRecT* self)
 {
     char* lang = NULL;
 
-    if (G_LIKELY(self)) {
-        NdefRecTPriv* priv = self->priv;
-
-        lang = priv->lang;
-        self->lang = priv->lang = NULL;
+    if (G_LIKELY(self) && self->lang) {
+        lang = g_strdup(self->lang);
+        self->lang = NULL;
     }
     return lang;
 }
@@ -347,11 +245,9 @@ ndef_rec_t_steal_text(
 {
     char* text = NULL;
 
-    if (G_LIKELY(self)) {
-        NdefRecTPriv* priv = self->priv;
-
-        text = priv->text;
-        self->text = priv->text = NULL;
+    if (G_LIKELY(self) && self->text) {
+        text = g_strdup(self->text);
+        self->text = NULL;
     }
     return text;
 }
@@ -365,7 +261,58 @@ void
 ndef_rec_t_init(
     NdefRecT* self)
 {
-    self->priv = G_TYPE_INSTANCE_GET_PRIVATE(self, THIS_TYPE, NdefRecTPriv);
+    self->priv = ndef_rec_t_get_instance_private(self);
+}
+
+static
+void
+ndef_rec_t_clear(
+    NdefRec* rec)
+{
+    NdefRecT* self = THIS(rec);
+    NdefRecTPriv* priv = self->priv;
+
+    g_free(priv->data);
+    priv->data = NULL;
+    self->lang = self->text = NULL;
+    ((NdefRecClass*)PARENT_CLASS)->clear(rec);
+}
+
+static
+NdefRec*
+ndef_rec_t_dup(
+    NdefRec* rec,
+    const NdefData* ndef,
+    NdefParseCtx* ctx)
+{
+    NdefRecT* src = THIS(rec);
+    NdefRtdText* data = src->priv->data;
+
+    if (src->lang && src->text) {
+        NdefRecT* self = THIS(ndef_rec_object_new(THIS_TYPE));
+        NdefRec* dest = &self->rec;
+
+        if (data) {
+            /* Converted from UTF-16, the result gets copied */
+            ndef_rec_initialize_spare(dest, NDEF_RTD_TEXT, ndef, 0, ctx);
+            ndef_rec_t_set_data(self, ndef_rtd_text_new(src->text,
+                src->lang, data->enc));
+        } else {
+            /* Same layout as what ndef_rec_t_new_from_data() produces */
+            GUtilData lang;
+            const char* tag = ndef_intern(gutil_data_from_string(&lang,
+                src->lang));
+            char* spare = (char*) ndef_rec_initialize_spare(dest,
+                NDEF_RTD_TEXT, ndef, tag ? 1 : (lang.size + 2), ctx);
+
+            self->lang = tag ? tag : memcpy(spare + 1, lang.bytes,
+                lang.size);
+            self->text = (const char*) dest->raw.bytes +
+                (src->text - (const char*) rec->raw.bytes);
+        }
+        return dest;
+    }
+    return NULL;
 }
 
 static
@@ -376,8 +323,7 @@ ndef_rec_t_finalize(
     NdefRecT* self = THIS(object);
     NdefRecTPriv* priv = self->priv;
 
-    g_free(priv->lang);
-    g_free(priv->text);
+    g_free(priv->data);
     G_OBJECT_CLASS(PARENT_CLASS)->finalize(object);
 }
 
@@ -386,8 +332,9 @@ void
 ndef_rec_t_class_init(
     NdefRecTClass* klass)
 {
-    g_type_class_add_private(klass, sizeof(NdefRecTPriv));
     G_OBJECT_CLASS(klass)->finalize = ndef_rec_t_finalize;
+    klass->clear = ndef_rec_t_clear;
+    klass->dup = ndef_rec_t_dup;
 }
 
 /*
@@ -38,15 +38,16 @@
  */
 
 #include "ndef_rec_p.h"
-#include "ndef_log.h"
+#include "ndef_util_p.h"
 
 #include <gutil_misc.h>
 
-/* NFCForum-TS-RTD_URI_1.0 */
-
-struct nfc_ndef_rec_u_priv {
-    char* uri;
-};
+/*
+ * NFCForum-TS-RTD_URI_1.0
+ *
+ * The decoded URI is always stored right after the record, so there's
+ * no private data (and the priv pointer stays NULL).
+ */
 
 #define THIS(obj) NDEF_REC_U(obj)
 #define THIS_TYPE NDEF_TYPE_REC_U
@@ -56,105 +57,6 @@ struct nfc_ndef_rec_u_priv {
 typedef NdefRecClass NdefRecUClass;
 G_DEFINE_TYPE(NdefRecU, ndef_rec_u, PARENT_TYPE)
 
-const GUtilData ndef_rec_type_u = { (const guint8*) "U", 1 };
-
-/* Table 3 */
-static const GUtilData ndef_rec_u_abbreviation_table[] = {
-    /* 0x00 */ { NULL, 0 },
-    /* 0x01 */ { (const guint8*) "http://www.", 11 },
-    /* 0x02 */ { (const guint8*) "https://www.", 12 },
-    /* 0x03 */ { (const guint8*) "http://", 7 },
-    /* 0x04 */ { (const guint8*) "https://", 8 },
-    /* 0x05 */ { (const guint8*) "tel:", 4 },
-    /* 0x06 */ { (const guint8*) "mailto:", 7 },
-    /* 0x07 */ { (const guint8*) "ftp://anonymous:anonymous@", 26 },
-    /* 0x08 */ { (const guint8*) "ftp://ftp.", 10 },
-    /* 0x09 */ { (const guint8*) "ftps://", 7 },
-    /* 0x0A */ { (const guint8*) "sftp://", 7 },
-    /* 0x0B */ { (const guint8*) "smb://", 6 },
-    /* 0x0C */ { (const guint8*) "nfs://", 6 },
-    /* 0x0D */ { (const guint8*) "ftp://", 6 },
-    /* 0x0E */ { (const guint8*) "dav://", 6 },
-    /* 0x0F */ { (const guint8*) "news:", 5 },
-    /* 0x10 */ { (const guint8*) "telnet://", 9 },
-    /* 0x11 */ { (const guint8*) "imap:", 5 },
-    /* 0x12 */ { (const guint8*) "rtsp://", 7 },
-    /* 0x13 */ { (const guint8*) "urn:", 4 },
-    /* 0x14 */ { (const guint8*) "pop:", 4 },
-    /* 0x15 */ { (const guint8*) "sip:", 4 },
-    /* 0x16 */ { (const guint8*) "sips:", 5 },
-    /* 0x17 */ { (const guint8*) "tftp:", 5 },
-    /* 0x18 */ { (const guint8*) "btspp://", 8 },
-    /* 0x19 */ { (const guint8*) "btl2cap://", 10 },
-    /* 0x1A */ { (const guint8*) "btgoep://", 9 },
-    /* 0x1B */ { (const guint8*) "tcpobex://", 10 },
-    /* 0x1C */ { (const guint8*) "irdaobex://", 11 },
-    /* 0x1D */ { (const guint8*) "file://", 7 },
-    /* 0x1E */ { (const guint8*) "urn:epc:id:", 11 },
-    /* 0x1F */ { (const guint8*) "urn:epc:tag:", 12 },
-    /* 0x20 */ { (const guint8*) "urn:epc:pat:", 12 },
-    /* 0x21 */ { (const guint8*) "urn:epc:raw:", 12 },
-    /* 0x22 */ { (const guint8*) "urn:epc:", 8 },
-    /* 0x23 */ { (const guint8*) "urn:nfc:", 7 },
-};
-
-static
-GBytes*
-ndef_rec_u_build(
-    const char* uri)
-{
-    GByteArray* buf = g_byte_array_new();
-    gsize len = strlen(uri);
-    guint8 i;
-
-    /* Skip the first one, the one that means "no abbreviation" */
-    for (i = 1; i < G_N_ELEMENTS(ndef_rec_u_abbreviation_table); i++) {
-        const GUtilData* abbr = ndef_rec_u_abbreviation_table + i;
-
-        if (len >= abbr->size && !memcmp(uri, abbr->bytes, abbr->size)) {
-            g_byte_array_append(buf, &i, 1);
-            uri += abbr->size;
-            len -= abbr->size;
-            break;
-        }
-    }
-
-    if (!buf->len) {
-        /* No abbreviation */
-        i = 0;
-        g_byte_array_append(buf, &i, 1);
-    }
-
-    /* Append the rest */
-    g_byte_array_append(buf, (const guint8*)uri, len);
-    return g_byte_array_free_to_bytes(buf);
-}
-
-static
-char*
-ndef_rec_u_parse(
-    const GUtilData* payload)
-{
-    /* ndef_payload() makes sure that payload length > 0 */
-    const guint8 prefix_id = payload->bytes[0];
-
-    if (prefix_id < G_N_ELEMENTS(ndef_rec_u_abbreviation_table)) {
-        const GUtilData* abbr = ndef_rec_u_abbreviation_table + prefix_id;
-        guint len = abbr->size + payload->size - 1;
-        char* uri = g_malloc(len + 1);
-
-        if (abbr->size) {
-            memcpy(uri, abbr->bytes, abbr->size);
-        }
-        memcpy(uri + abbr->size, payload->bytes + 1, payload->size - 1);
-        uri[len] = 0;
-        return uri;
-    } else {
-        GDEBUG("Unknown URI Record prefix 0x02%x", prefix_id);
-        return NULL;
-    }
-}
-
 /*==========================================================================*
  * Interface
  *==========================================================================*/
@@ -164,16 +66,25 @@ ndef_rec_u_new(
     const char* uri)
 {
     if (G_LIKELY(uri)) {
-        GUtilData payload;
-        GBytes* payload_bytes = ndef_rec_u_build(uri);
-        NdefRecU* self = THIS(ndef_rec_new_well_known(THIS_TYPE,
-            NDEF_RTD_URI, &ndef_rec_type_u,
-            gutil_data_from_bytes(&payload, payload_bytes)));
-        NdefRecUPriv* priv = self->priv;
-
-        self->uri = priv->uri = g_strdup(uri);
-        g_bytes_unref(payload_bytes);
-        return self;
+        const gsize len = strlen(uri);
+        gsize prefix_len, suffix_len;
+        const guint8 id = ndef_uri_prefix(uri, len, &prefix_len);
+        guint8* payload;
+        NdefRec* rec;
+
+        /* The URI itself is stored right after the record */
+        suffix_len = len - prefix_len;
+        rec = ndef_rec_new_with_payload(THIS_TYPE, NDEF_TNF_WELL_KNOWN,
+            NDEF_RTD_URI, &ndef_rec_type_u, 1 + suffix_len, len + 1,
+            &payload);
+        if (rec) {
+            NdefRecU* self = THIS(rec);
+
+            payload[0] = id;
+            memcpy(payload + 1, uri + prefix_len, suffix_len);
+            self->uri = memcpy(payload + 1 + suffix_len, uri, len);
+            return self;
+        }
     }
     return NULL;
 }
@@ -184,21 +95,27 @@ ndef_rec_u_new(
 
 NdefRecU*
 ndef_rec_u_new_from_data(
-    const NdefData* ndef)
+    const NdefData* ndef,
+    NdefParseCtx* ctx)
 {
-    GUtilData payload;
-
-    if (ndef_payload(ndef, &payload)) {
-        char* uri = ndef_rec_u_parse(&payload);
-
-        if (uri) {
-            NdefRecU* self = g_object_new(THIS_TYPE, NULL);
-            NdefRecUPriv* priv = self->priv;
-
-            ndef_rec_initialize(&self->rec, NDEF_RTD_URI, ndef);
-            self->uri = priv->uri = uri;
-            return self;
+    GUtilData payload, prefix, suffix;
+
+    if (ndef_payload(ndef, &payload) &&
+        ndef_uri_split(&payload, &prefix, &suffix)) {
+        NdefRecU* self = THIS(ndef_rec_object_new(THIS_TYPE));
+        char* uri;
+
+        /* The decoded URI is stored right after the record */
+        uri = (char*) ndef_rec_initialize_spare(&self->rec, NDEF_RTD_URI,
+            ndef, prefix.size + suffix.size + 1, ctx);
+        if (prefix.size) {
+            memcpy(uri, prefix.bytes, prefix.size);
+        }
+        if (suffix.size) {
+            memcpy(uri + prefix.size, suffix.bytes, suffix.size);
         }
+        self->uri = uri;
+        return self;
     }
     return NULL;
 }
@@ -210,10 +127,9 @@ ndef_rec_u_steal_uri(
     char* uri = NULL;
 
     if (G_LIKELY(self)) {
-        NdefRecUPriv* priv = self->priv;
-
-        uri = priv->uri;
-        self->uri = priv->uri = NULL;
+        /* The URI points into the record, it gets copied */
+        uri = g_strdup(self->uri);
+        self->uri = NULL;
     }
     return uri;
 }
@@ -227,19 +143,38 @@ void
 ndef_rec_u_init(
     NdefRecU* self)
 {
-    self->priv = G_TYPE_INSTANCE_GET_PRIVATE(self, THIS_TYPE, NdefRecUPriv);
 }
 
 static
 void
-ndef_rec_u_finalize(
-    GObject* object)
+ndef_rec_u_clear(
+    NdefRec* rec)
 {
-    NdefRecU* self = THIS(object);
-    NdefRecUPriv* priv = self->priv;
+    THIS(rec)->uri = NULL;
+    ((NdefRecClass*)PARENT_CLASS)->clear(rec);
+}
 
-    g_free(priv->uri);
-    G_OBJECT_CLASS(PARENT_CLASS)->finalize(object);
+static
+NdefRec*
+ndef_rec_u_dup(
+    NdefRec* rec,
+    const NdefData* ndef,
+    NdefParseCtx* ctx)
+{
+    NdefRecU* src = THIS(rec);
+
+    if (src->uri) {
+        NdefRecU* self = THIS(ndef_rec_object_new(THIS_TYPE));
+        const gsize len = strlen(src->uri);
+        char* uri = (char*) ndef_rec_initialize_spare(&self->rec,
+            NDEF_RTD_URI, ndef, len + 1, ctx);
+
+        /* Same layout as what ndef_rec_u_new_from_data() produces */
+        memcpy(uri, src->uri, len);
+        self->uri = uri;
+        return &self->rec;
+    }
+    return NULL;
 }
 
 static
@@ -247,8 +182,8 @@ void
 ndef_rec_u_class_init(
     NdefRecUClass* klass)
 {
-    g_type_class_add_private(klass, sizeof(NdefRecUPriv));
-    G_OBJECT_CLASS(klass)->finalize = ndef_rec_u_finalize;
+    klass->clear = ndef_rec_u_clear;
+    klass->dup = ndef_rec_u_dup;
 }
 
 /*
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "ndef_util_p.h"
+#include "ndef_log.h"
+
+#include <gutil_misc.h>
+
+#include <stdlib.h>
+
+/*
+ * Each slot is protected by its own sequence number, seqlock style.
+ * The writer zeroes it before touching the slot and sets it to the
+ * sequence number of the new entry when it's done. The reader makes
+ * a copy and then checks that the sequence number hasn't changed.
+ */
+
+typedef struct ndef_reject_slot {
+    volatile gint seq;
+    NdefReject entry;
+} NdefRejectSlot;
+
+static NdefRejectSlot ndef_reject_ring[NDEF_REJECT_MAX];
+static volatile gint ndef_reject_last_seq = 0;
+
+static
+gboolean
+ndef_reject_read(
+    const NdefRejectSlot* slot,
+    NdefReject* entry)
+{
+    const guint seq = (guint) g_atomic_int_get(&slot->seq);
+
+    if (seq) {
+        memcpy(entry, &slot->entry, sizeof(*entry));
+        if ((guint) g_atomic_int_get(&slot->seq) == seq) {
+            entry->seq = seq;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static
+gint
+ndef_reject_compare(
+    gconstpointer a,
+    gconstpointer b)
+{
+    const NdefReject* r1 = a;
+    const NdefReject* r2 = b;
+
+    /* Handle wraparound */
+    return (gint)(r1->seq - r2->seq);
+}
+
+/*==========================================================================*
+ * Interface
+ *==========================================================================*/
+
+guint
+ndef_reject_get(
+    NdefReject* buf,
+    guint max)
+{
+    guint n = 0;
+
+    if (G_LIKELY(buf) && max) {
+        NdefReject tmp[NDEF_REJECT_MAX];
+        guint i;
+
+        for (i = 0; i < NDEF_REJECT_MAX; i++) {
+            if (ndef_reject_read(ndef_reject_ring + i, tmp + n)) {
+                n++;
+            }
+        }
+        if (n > 1) {
+            qsort(tmp, n, sizeof(tmp[0]), ndef_reject_compare);
+        }
+        if (n > max) {
+            /* Keep the most recent ones */
+            memcpy(buf, tmp + (n - max), sizeof(tmp[0]) * max);
+            n = max;
+        } else {
+            memcpy(buf, tmp, sizeof(tmp[0]) * n);
+        }
+    }
+    return n;
+}
+
+void
+ndef_reject_dump(
+    void)
+{
+    NdefReject entries[NDEF_REJECT_MAX];
+    const guint n = ndef_reject_get(entries, G_N_ELEMENTS(entries));
+    const int level = GLOG_LEVEL_ALWAYS;
+    guint i;
+
+    for (i = 0; i < n; i++) {
+        const NdefReject* r = entries + i;
+        const guint8* ptr = r->data;
+        guint len = r->data_size;
+        guint off = r->data_offset;
+
+        gutil_log(&GLOG_MODULE_NAME, level, "#%u %s (offset %u of %u)",
+            r->seq, r->reason, (guint) r->offset, (guint) r->size);
+        while (len > 0) {
+            char line[GUTIL_HEXDUMP_BUFSIZE];
+            const guint consumed = gutil_hexdump(line, ptr, len);
+
+            gutil_log(&GLOG_MODULE_NAME, level, "  %04X: %s", off, line);
+            ptr += consumed;
+            len -= consumed;
+            off += consumed;
+        }
+    }
+}
+
+void
+ndef_reject_clear(
+    void)
+{
+    guint i;
+
+    for (i = 0; i < NDEF_REJECT_MAX; i++) {
+        g_atomic_int_set(&ndef_reject_ring[i].seq, 0);
+    }
+}
+
+/*==========================================================================*
+ * Internal interface
+ *==========================================================================*/
+
+void
+ndef_reject(
+    const GUtilData* input,
+    gsize offset,
+    const char* reason)
+{
+    const guint seq = (guint) g_atomic_int_add(&ndef_reject_last_seq, 1) + 1;
+
+    /* Zero sequence number is reserved for slots being written */
+    if (G_LIKELY(seq)) {
+        NdefRejectSlot* slot = ndef_reject_ring + (seq % NDEF_REJECT_MAX);
+        NdefReject* entry = &slot->entry;
+        gsize start = 0;
+
+        /* Try to capture some context preceding the offending byte */
+        if (offset > NDEF_REJECT_DATA_MAX / 4) {
+            start = offset - NDEF_REJECT_DATA_MAX / 4;
+        }
+        if (start > input->size) {
+            start = input->size;
+        }
+
+        g_atomic_int_set(&slot->seq, 0);
+        entry->seq = seq;
+        entry->reason = reason;
+        entry->size = input->size;
+        entry->offset = offset;
+        entry->data_offset = start;
+        entry->data_size = MIN(input->size - start, NDEF_REJECT_DATA_MAX);
+        if (entry->data_size) {
+            memcpy(entry->data, input->bytes + start, entry->data_size);
+        }
+        g_atomic_int_set(&slot->seq, seq);
+    }
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,1068 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "ndef_rtd.h"
+#include "ndef_msg.h"
+#include "ndef_util_p.h"
+#include "ndef_log.h"
+
+#include <gutil_misc.h>
+
+/*
+ * Encoding and decoding of the well-known record payloads. None of
+ * this depends on GObject.
+ */
+
+const GUtilData ndef_rec_type_u = { (const guint8*) "U", 1 };
+const GUtilData ndef_rec_type_t = { (const guint8*) "T", 1 };
+const GUtilData ndef_rec_type_sp = { (const guint8*) "Sp", 2 };
+const GUtilData ndef_sp_type_act = { (const guint8*) "act", 3 };
+const GUtilData ndef_sp_type_s = { (const guint8*) "s", 1 };
+const GUtilData ndef_sp_type_t = { (const guint8*) "t", 1 };
+
+/* NFCForum-TS-RTD_URI_1.0 */
+
+/* Table 3 */
+static const GUtilData ndef_uri_abbreviation_table[] = {
+    /* 0x00 */ { NULL, 0 },
+    /* 0x01 */ { (const guint8*) "http://www.", 11 },
+    /* 0x02 */ { (const guint8*) "https://www.", 12 },
+    /* 0x03 */ { (const guint8*) "http://", 7 },
+    /* 0x04 */ { (const guint8*) "https://", 8 },
+    /* 0x05 */ { (const guint8*) "tel:", 4 },
+    /* 0x06 */ { (const guint8*) "mailto:", 7 },
+    /* 0x07 */ { (const guint8*) "ftp://anonymous:anonymous@", 26 },
+    /* 0x08 */ { (const guint8*) "ftp://ftp.", 10 },
+    /* 0x09 */ { (const guint8*) "ftps://", 7 },
+    /* 0x0A */ { (const guint8*) "sftp://", 7 },
+    /* 0x0B */ { (const guint8*) "smb://", 6 },
+    /* 0x0C */ { (const guint8*) "nfs://", 6 },
+    /* 0x0D */ { (const guint8*) "ftp://", 6 },
+    /* 0x0E */ { (const guint8*) "dav://", 6 },
+    /* 0x0F */ { (const guint8*) "news:", 5 },
+    /* 0x10 */ { (const guint8*) "telnet://", 9 },
+    /* 0x11 */ { (const guint8*) "imap:", 5 },
+    /* 0x12 */ { (const guint8*) "rtsp://", 7 },
+    /* 0x13 */ { (const guint8*) "urn:", 4 },
+    /* 0x14 */ { (const guint8*) "pop:", 4 },
+    /* 0x15 */ { (const guint8*) "sip:", 4 },
+    /* 0x16 */ { (const guint8*) "sips:", 5 },
+    /* 0x17 */ { (const guint8*) "tftp:", 5 },
+    /* 0x18 */ { (const guint8*) "btspp://", 8 },
+    /* 0x19 */ { (const guint8*) "btl2cap://", 10 },
+    /* 0x1A */ { (const guint8*) "btgoep://", 9 },
+    /* 0x1B */ { (const guint8*) "tcpobex://", 10 },
+    /* 0x1C */ { (const guint8*) "irdaobex://", 11 },
+    /* 0x1D */ { (const guint8*) "file://", 7 },
+    /* 0x1E */ { (const guint8*) "urn:epc:id:", 11 },
+    /* 0x1F */ { (const guint8*) "urn:epc:tag:", 12 },
+    /* 0x20 */ { (const guint8*) "urn:epc:pat:", 12 },
+    /* 0x21 */ { (const guint8*) "urn:epc:raw:", 12 },
+    /* 0x22 */ { (const guint8*) "urn:epc:", 8 },
+    /* 0x23 */ { (const guint8*) "urn:nfc:", 7 },
+};
+
+/* Returns the abbreviation code, zero if there's none */
+guint8
+ndef_uri_prefix(
+    const char* uri,
+    gsize len,
+    gsize* prefix_len)
+{
+    guint8 i;
+
+    /* Skip the first one, the one that means "no abbreviation" */
+    for (i = 1; i < G_N_ELEMENTS(ndef_uri_abbreviation_table); i++) {
+        const GUtilData* abbr = ndef_uri_abbreviation_table + i;
+
+        if (len >= abbr->size && !memcmp(uri, abbr->bytes, abbr->size)) {
+            *prefix_len = abbr->size;
+            return i;
+        }
+    }
+
+    /* No abbreviation */
+    *prefix_len = 0;
+    return 0;
+}
+
+GBytes*
+ndef_uri_encode(
+    const char* uri)
+{
+    const gsize len = strlen(uri);
+    gsize prefix_len;
+    const guint8 id = ndef_uri_prefix(uri, len, &prefix_len);
+    GByteArray* buf = g_byte_array_sized_new(1 + len - prefix_len);
+
+    g_byte_array_append(buf, &id, 1);
+    g_byte_array_append(buf, (const guint8*)uri + prefix_len,
+        len - prefix_len);
+    return g_byte_array_free_to_bytes(buf);
+}
+
+gboolean
+ndef_uri_split(
+    const GUtilData* payload,
+    GUtilData* prefix,
+    GUtilData* suffix)
+{
+    if (payload->size) {
+        const guint8 prefix_id = payload->bytes[0];
+
+        if (prefix_id < G_N_ELEMENTS(ndef_uri_abbreviation_table)) {
+            *prefix = ndef_uri_abbreviation_table[prefix_id];
+            suffix->bytes = payload->bytes + 1;
+            suffix->size = payload->size - 1;
+            return TRUE;
+        }
+        GDEBUG("Unknown URI Record prefix 0x%02x", prefix_id);
+    }
+    return FALSE;
+}
+
+/* NFCForum-TS-RTD_TEXT_1.0 */
+
+#define STATUS_LANG_LEN_MASK (0x3f)
+#define STATUS_ENC_UTF16 (0x80) /* Otherwise UTF-8 */
+
+static const char ENC_UTF8[] = "UTF-8";
+static const char ENC_UTF16_LE[] = "UTF-16LE";
+static const char ENC_UTF16_BE[] = "UTF-16BE";
+
+/* UTF-16 Byte Order Marks */
+static const guint8 UTF16_BOM_LE[] = {0xff, 0xfe};
+static const guint8 UTF16_BOM_BE[] = {0xfe, 0xff};
+
+GBytes*
+ndef_text_encode(
+    const char* text,
+    const char* lang,
+    NDEF_REC_T_ENC enc)
+{
+    const guint8 lang_len = strlen(lang);
+    const gsize text_len = strlen(text);
+    const guint8 status_byte = (lang_len & STATUS_LANG_LEN_MASK) |
+        ((enc == NDEF_REC_T_ENC_UTF8) ? 0 : STATUS_ENC_UTF16);
+    const guint8* bom = NULL;
+    const void* enc_text = NULL;
+    void* enc_text_tmp = NULL;
+    gsize enc_text_len;
+    gsize bom_len = 0;
+    GError* err = NULL;
+
+    switch (enc) {
+    case NDEF_REC_T_ENC_UTF8:
+        enc_text = text;
+        enc_text_len = text_len;
+        break;
+    case NDEF_REC_T_ENC_UTF16BE:
+         enc_text = enc_text_tmp = g_convert(text, text_len, ENC_UTF16_BE,
+            ENC_UTF8, NULL, &enc_text_len, &err);
+         break;
+    case NDEF_REC_T_ENC_UTF16LE:
+        bom = UTF16_BOM_LE;
+        bom_len = sizeof(UTF16_BOM_LE);
+        enc_text = enc_text_tmp = g_convert(text, text_len, ENC_UTF16_LE,
+            ENC_UTF8, NULL, &enc_text_len, &err);
+        break;
+    }
+
+    if (enc_text) {
+        GByteArray* buf = g_byte_array_sized_new(1 + lang_len + bom_len +
+            enc_text_len);
+
+        g_byte_array_append(buf, &status_byte, 1);
+        g_byte_array_append(buf, (const guint8*)lang, lang_len);
+        if (bom) g_byte_array_append(buf, bom, bom_len);
+        g_byte_array_append(buf, enc_text, enc_text_len);
+        g_free(enc_text_tmp);
+        return g_byte_array_free_to_bytes(buf);
+    } else {
+        if (err) {
+            NDEF_WARN("Failed to encode Text record: %s", err->message);
+            g_error_free(err);
+        } else {
+            NDEF_WARN("Failed to encode Text record");
+        }
+        return NULL;
+    }
+}
+
+gboolean
+ndef_text_split(
+    const GUtilData* payload,
+    GUtilData* lang,
+    GUtilData* text,
+    NDEF_REC_T_ENC* enc)
+{
+    if (payload->size) {
+        const guint8 status_byte = payload->bytes[0];
+        const guint lang_len = (status_byte & STATUS_LANG_LEN_MASK);
+
+        if ((lang_len < payload->size) && /* Empty or ASCII (or UTF-8) */
+            (!lang_len || g_utf8_validate((const char*)payload->bytes + 1,
+            lang_len, NULL))) {
+            lang->bytes = payload->bytes + 1;
+            lang->size = lang_len;
+            text->bytes = lang->bytes + lang_len;
+            text->size = payload->size - lang_len - 1;
+            if (status_byte & STATUS_ENC_UTF16) {
+                if (text->size >= sizeof(UTF16_BOM_BE) &&
+                    !memcmp(text->bytes, UTF16_BOM_BE,
+                    sizeof(UTF16_BOM_BE))) {
+                    text->bytes += sizeof(UTF16_BOM_BE);
+                    text->size -= sizeof(UTF16_BOM_BE);
+                    *enc = NDEF_REC_T_ENC_UTF16BE;
+                } else if (text->size >= sizeof(UTF16_BOM_LE) &&
+                    !memcmp(text->bytes, UTF16_BOM_LE,
+                    sizeof(UTF16_BOM_LE))) {
+                    text->bytes += sizeof(UTF16_BOM_LE);
+                    text->size -= sizeof(UTF16_BOM_LE);
+                    *enc = NDEF_REC_T_ENC_UTF16LE;
+                } else {
+                    /*
+                     * 3.4 UTF-16 Byte Order
+                     *
+                     * ... If the BOM is omitted, the byte order shall be
+                     * big-endian (UTF-16 BE).
+                     */
+                    *enc = NDEF_REC_T_ENC_UTF16BE;
+                }
+            } else {
+                *enc = NDEF_REC_T_ENC_UTF8;
+            }
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+char*
+ndef_text_decode(
+    const GUtilData* text,
+    NDEF_REC_T_ENC enc)
+{
+    if (!text->size) {
+        return g_strdup("");
+    } else if (enc == NDEF_REC_T_ENC_UTF8) {
+        if (g_utf8_validate((const char*)text->bytes, text->size, NULL)) {
+            return g_strndup((const char*)text->bytes, text->size);
+        }
+    } else {
+        GError* err = NULL;
+        char* utf8 = g_convert((const char*)text->bytes, text->size,
+            ENC_UTF8, (enc == NDEF_REC_T_ENC_UTF16LE) ? ENC_UTF16_LE :
+            ENC_UTF16_BE, NULL, NULL, &err);
+
+        if (!err) {
+            return utf8;
+        }
+        NDEF_WARN("Failed to decode Text record: %s", err->message);
+        g_error_free(err);
+        g_free(utf8); /* Should be NULL already */
+    }
+    return NULL;
+}
+
+void
+ndef_scratch_init(
+    NdefScratch* scratch)
+{
+    memset(scratch, 0, sizeof(*scratch));
+    scratch->utf16[0] = scratch->utf16[1] = (GIConv) -1;
+}
+
+void
+ndef_scratch_clear(
+    NdefScratch* scratch)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS(scratch->utf16); i++) {
+        if (scratch->utf16[i] != (GIConv) -1) {
+            g_iconv_close(scratch->utf16[i]);
+        }
+    }
+    g_free(scratch->buf);
+    ndef_scratch_init(scratch);
+}
+
+gboolean
+ndef_scratch_utf16(
+    NdefScratch* scratch,
+    const GUtilData* text,
+    NDEF_REC_T_ENC enc,
+    GUtilData* utf8)
+{
+    const guint i = (enc == NDEF_REC_T_ENC_UTF16LE) ? 0 : 1;
+    /* Each UTF-16 code unit takes at most 3 bytes in UTF-8 */
+    const gsize max = text->size / 2 * 3 + 1;
+    GIConv conv = scratch->utf16[i];
+
+    if (conv == (GIConv) -1) {
+        conv = g_iconv_open(ENC_UTF8, i ? ENC_UTF16_BE : ENC_UTF16_LE);
+        if (conv == (GIConv) -1) {
+            NDEF_WARN("Failed to open UTF-16 converter");
+            return FALSE;
+        }
+        scratch->utf16[i] = conv;
+    } else {
+        /* Reset the state left by the previous failure, if any */
+        g_iconv(conv, NULL, NULL, NULL, NULL);
+    }
+
+    if (scratch->size < max) {
+        g_free(scratch->buf);
+        scratch->buf = g_malloc(max);
+        scratch->size = max;
+    }
+
+    if (text->size) {
+        gchar* in = (gchar*) text->bytes;
+        gchar* out = scratch->buf;
+        gsize in_left = text->size;
+        gsize out_left = max - 1;
+
+        if (g_iconv(conv, &in, &in_left, &out, &out_left) == (gsize) -1 ||
+            in_left) {
+            NDEF_WARN("Failed to decode Text record");
+            return FALSE;
+        }
+        *out = 0;
+    } else {
+        scratch->buf[0] = 0;
+    }
+
+    /* Same as g_convert() followed by strlen() */
+    utf8->bytes = (const guint8*) scratch->buf;
+    utf8->size = strlen(scratch->buf);
+    return TRUE;
+}
+
+NDEF_LANG_MATCH
+ndef_lang_match(
+    const GUtilData* tag,
+    const NdefLanguage* lang)
+{
+    NDEF_LANG_MATCH match = NDEF_LANG_MATCH_NONE;
+
+    if (G_LIKELY(lang) && G_LIKELY(lang->language)) {
+        const char* str = (const char*) tag->bytes;
+        const char* sep = tag->size ? memchr(str, '-', tag->size) : NULL;
+        const gsize lang_len = sep ? (gsize)(sep - str) : tag->size;
+
+        if (strlen(lang->language) == lang_len &&
+            !g_ascii_strncasecmp(str, lang->language, lang_len)) {
+            match |= NDEF_LANG_MATCH_LANGUAGE;
+        }
+        if (sep && lang->territory && lang->territory[0]) {
+            const gsize terr_len = tag->size - lang_len - 1;
+
+            if (strlen(lang->territory) == terr_len &&
+                !g_ascii_strncasecmp(sep + 1, lang->territory, terr_len)) {
+                match |= NDEF_LANG_MATCH_TERRITORY;
+            }
+        }
+    }
+    return match;
+}
+
+static
+char*
+ndef_rtd_copy(
+    char** ptr,
+    const GUtilData* data)
+{
+    char* str = *ptr;
+
+    if (data->size) {
+        memcpy(str, data->bytes, data->size);
+    }
+    str[data->size] = 0;
+    *ptr = str + data->size + 1;
+    return str;
+}
+
+static
+NdefRtdText*
+ndef_rtd_text_alloc(
+    const GUtilData* lang,
+    const GUtilData* text,
+    NDEF_REC_T_ENC enc)
+{
+    /* The strings immediately follow the structure, unless interned */
+    const char* tag = ndef_intern(lang);
+    NdefRtdText* rtd = g_malloc(sizeof(NdefRtdText) + text->size + 1 +
+        (tag ? 0 : (lang->size + 1)));
+    char* ptr = (char*)(rtd + 1);
+
+    rtd->lang = tag ? tag : ndef_rtd_copy(&ptr, lang);
+    rtd->text = ndef_rtd_copy(&ptr, text);
+    rtd->enc = enc;
+    return rtd;
+}
+
+/* The UTF-8 result points either to the input or to the scratch buffer */
+static
+gboolean
+ndef_rtd_text_utf8(
+    NdefScratch* scratch,
+    const GUtilData* payload,
+    const GUtilData* lang,
+    const GUtilData* text,
+    NDEF_REC_T_ENC enc,
+    GUtilData* utf8)
+{
+    if (enc == NDEF_REC_T_ENC_UTF8) {
+        if (g_utf8_validate((const char*)text->bytes, text->size, NULL)) {
+            *utf8 = *text;
+            return TRUE;
+        }
+    } else if (ndef_scratch_utf16(scratch, text, enc, utf8)) {
+        return TRUE;
+    }
+    ndef_reject(payload, lang->size + 1, (enc == NDEF_REC_T_ENC_UTF8) ?
+        "Invalid UTF-8 text" : "Invalid UTF-16 text");
+    return FALSE;
+}
+
+/* NFCForum-SmartPoster_RTD_1.0 */
+
+typedef struct ndef_rtd_sp_decoder {
+    const GUtilData* payload;
+    gboolean stop;
+    gboolean uri;
+    GUtilData prefix;
+    GUtilData suffix;
+    NdefScratch* scratch;
+    gboolean title;
+    GUtilData title_utf8;
+    GUtilData title_text;
+    NDEF_REC_T_ENC title_enc;
+    GUtilData lang;
+    NDEF_LANG_MATCH title_match;
+    NdefLanguage* system;
+    gboolean system_known;
+    GUtilData type;
+    GUtilData icon_type;
+    GUtilData icon_data;
+    guint size;
+    NDEF_SP_ACT act;
+} NdefRtdSpDecoder;
+
+static
+NdefRtdSp*
+ndef_rtd_sp_alloc(
+    const GUtilData* prefix, /* Optional */
+    const GUtilData* uri,
+    const GUtilData* title,
+    const GUtilData* lang,
+    const GUtilData* type,
+    guint size,
+    NDEF_SP_ACT act,
+    const GUtilData* icon_type,
+    const GUtilData* icon_data,
+    NdefRtdAllocFunc alloc,
+    gpointer user_data)
+{
+    /*
+     * Everything is allocated from a single memory block, except for
+     * the interned language and media types.
+     */
+    const char* lang_tag = title ? ndef_intern(lang) : NULL;
+    const char* type_str = type ? ndef_intern(type) : NULL;
+    const char* icon_str = icon_type ? ndef_intern(icon_type) : NULL;
+    gsize total = sizeof(NdefRtdSp) + uri->size + 1;
+    NdefRtdSp* sp;
+    char* ptr;
+    char* str;
+
+    if (prefix) {
+        total += prefix->size;
+    }
+    if (title) {
+        total += title->size + 1;
+        if (!lang_tag) {
+            total += lang->size + 1;
+        }
+    }
+    if (type && !type_str) {
+        total += type->size + 1;
+    }
+    if (icon_type) {
+        total += sizeof(NdefMedia) + icon_data->size;
+        if (!icon_str) {
+            total += icon_type->size + 1;
+        }
+    }
+
+    sp = alloc ? alloc(total, user_data) : g_malloc0(total);
+    ptr = (char*)(sp + 1);
+    if (icon_type) {
+        /* NdefMedia needs to be aligned, it goes first */
+        NdefMedia* icon = (NdefMedia*)ptr;
+
+        ptr += sizeof(NdefMedia);
+        if (icon_data->size) {
+            memcpy(ptr, icon_data->bytes, icon_data->size);
+            icon->data.bytes = (const guint8*)ptr;
+            icon->data.size = icon_data->size;
+            ptr += icon_data->size;
+        }
+        icon->type = icon_str ? icon_str : ndef_rtd_copy(&ptr, icon_type);
+        sp->icon = icon;
+    }
+    str = ptr;
+    if (prefix && prefix->size) {
+        memcpy(ptr, prefix->bytes, prefix->size);
+        ptr += prefix->size;
+    }
+    ndef_rtd_copy(&ptr, uri);
+    sp->uri = str;
+    if (title) {
+        sp->title = ndef_rtd_copy(&ptr, title);
+        sp->lang = lang_tag ? lang_tag : ndef_rtd_copy(&ptr, lang);
+    }
+    if (type) {
+        sp->type = type_str ? type_str : ndef_rtd_copy(&ptr, type);
+    }
+    sp->size = size;
+    sp->act = act;
+    return sp;
+}
+
+static
+gboolean
+ndef_rtd_sp_uri(
+    const NdefMsgRec* rec,
+    const GUtilData* prefix,
+    const GUtilData* suffix,
+    gpointer user_data)
+{
+    NdefRtdSpDecoder* dec = user_data;
+
+    /* 3.3.1 The URI Record */
+    if (dec->uri) {
+        /* There MUST NOT be more than one URI record */
+        NDEF_WARN("SmartPoster NDEF contains multiple URI records");
+        ndef_reject(dec->payload, 0, "Multiple SmartPoster URIs");
+        dec->stop = TRUE;
+        return FALSE;
+    } else {
+        dec->uri = TRUE;
+        dec->prefix = *prefix;
+        dec->suffix = *suffix;
+        return TRUE;
+    }
+}
+
+static
+gboolean
+ndef_rtd_sp_text(
+    const NdefMsgRec* rec,
+    const GUtilData* lang,
+    const GUtilData* text,
+    NDEF_REC_T_ENC enc,
+    gpointer user_data)
+{
+    NdefRtdSpDecoder* dec = user_data;
+
+    /* 3.3.2 The Title Record */
+    if (dec->title) {
+        /*
+         * More than one title - need to choose. Keep the best match
+         * seen so far, the first one wins if there are several equally
+         * good. Only the candidates get converted to UTF-8.
+         */
+        if (!dec->system_known) {
+            dec->system_known = TRUE;
+            dec->system = ndef_system_language();
+            dec->title_match = ndef_lang_match(&dec->lang, dec->system);
+        }
+        if (dec->system && dec->title_match != NDEF_LANG_MATCH_FULL) {
+            const NDEF_LANG_MATCH match = ndef_lang_match(lang, dec->system);
+
+            if (match > dec->title_match) {
+                GUtilData utf8;
+
+                if (ndef_rtd_text_utf8(dec->scratch, &rec->payload, lang,
+                    text, enc, &utf8)) {
+                    dec->title_utf8 = utf8;
+                    dec->title_text = *text;
+                    dec->title_enc = enc;
+                    dec->title_match = match;
+                    dec->lang = *lang;
+                } else if (dec->title_enc != NDEF_REC_T_ENC_UTF8) {
+                    /* The scratch buffer has been overwritten */
+                    ndef_scratch_utf16(dec->scratch, &dec->title_text,
+                        dec->title_enc, &dec->title_utf8);
+                }
+            }
+        }
+    } else {
+        /* First title */
+        dec->title = ndef_rtd_text_utf8(dec->scratch, &rec->payload, lang,
+            text, enc, &dec->title_utf8);
+        dec->title_text = *text;
+        dec->title_enc = enc;
+        dec->lang = *lang;
+    }
+    return TRUE;
+}
+
+static
+gboolean
+ndef_rtd_sp_act(
+    const NdefMsgRec* rec,
+    NDEF_SP_ACT act,
+    gpointer user_data)
+{
+    NdefRtdSpDecoder* dec = user_data;
+
+    /* 3.3.3 The Recommended Action Record */
+    if (dec->act == NDEF_SP_ACT_DEFAULT) {
+        dec->act = act;
+    }
+    return TRUE;
+}
+
+static
+gboolean
+ndef_rtd_sp_size(
+    const NdefMsgRec* rec,
+    guint size,
+    gpointer user_data)
+{
+    NdefRtdSpDecoder* dec = user_data;
+
+    /* 3.3.5 The Size Record */
+    if (!dec->size) {
+        dec->size = size;
+    }
+    return TRUE;
+}
+
+static
+gboolean
+ndef_rtd_sp_type(
+    const NdefMsgRec* rec,
+    const GUtilData* type,
+    gpointer user_data)
+{
+    NdefRtdSpDecoder* dec = user_data;
+
+    /* 3.3.6 The Type Record */
+    if (!dec->type.size) {
+        dec->type = *type;
+    }
+    return TRUE;
+}
+
+static
+gboolean
+ndef_rtd_sp_icon(
+    const NdefMsgRec* rec,
+    const GUtilData* type,
+    const GUtilData* data,
+    gpointer user_data)
+{
+    NdefRtdSpDecoder* dec = user_data;
+
+    /* 3.3.4 The Icon Record */
+    if (!dec->icon_type.size) {
+        dec->icon_type = *type;
+        dec->icon_data = *data;
+    }
+    return TRUE;
+}
+
+static
+gboolean
+ndef_rtd_sp_other(
+    const NdefMsgRec* rec,
+    gpointer user_data)
+{
+    NdefRtdSpDecoder* dec = user_data;
+
+    if (rec->hdr & NDEF_HDR_CF) {
+        NDEF_WARN("Chunked records are not supported");
+        ndef_reject(dec->payload, rec->raw.bytes - dec->payload->bytes,
+            "Chunked record");
+    } else if (rec->tnf == NDEF_TNF_WELL_KNOWN) {
+        if (gutil_data_equal(&rec->type, &ndef_sp_type_act)) {
+            if (rec->payload.size == 1 && dec->act == NDEF_SP_ACT_DEFAULT) {
+                NDEF_WARN("Unsupport SmartPoster action %u", (guint)
+                    rec->payload.bytes[0]);
+            }
+        } else if (!gutil_data_equal(&rec->type, &ndef_sp_type_s) &&
+            !gutil_data_equal(&rec->type, &ndef_sp_type_t)) {
+            NDEF_WARN("Unsupported SmartPoster NDEF record \"%.*s\"",
+                (int) rec->type.size, rec->type.bytes);
+        }
+    } else if (rec->tnf != NDEF_TNF_MEDIA_TYPE) {
+        NDEF_WARN("Unsupported SmartPoster NDEF record");
+    }
+    return TRUE;
+}
+
+/*==========================================================================*
+ * Interface
+ *==========================================================================*/
+
+char*
+ndef_rtd_uri_decode(
+    const GUtilData* payload)
+{
+    GUtilData prefix, suffix;
+
+    return (G_LIKELY(payload) && ndef_uri_split(payload, &prefix, &suffix)) ?
+        ndef_msg_decode_uri(&prefix, &suffix) : NULL;
+}
+
+GBytes*
+ndef_rtd_uri_encode(
+    const char* uri)
+{
+    return G_LIKELY(uri) ? ndef_uri_encode(uri) : NULL;
+}
+
+NdefRtdText*
+ndef_rtd_text_decode(
+    const GUtilData* payload)
+{
+    return G_LIKELY(payload) ? ndef_rtd_text_decode_scratch(payload, NULL) :
+        NULL;
+}
+
+GBytes*
+ndef_rtd_text_encode(
+    const char* text,
+    const char* lang,
+    NDEF_REC_T_ENC enc)
+{
+    GBytes* payload;
+
+    if (lang) {
+        payload = ndef_text_encode(text ? text : "", lang, enc);
+    } else {
+        char* tag = ndef_default_lang_tag();
+
+        payload = ndef_text_encode(text ? text : "", tag, enc);
+        g_free(tag);
+    }
+    return payload;
+}
+
+NDEF_LANG_MATCH
+ndef_rtd_lang_match(
+    const char* tag,
+    const NdefLanguage* lang)
+{
+    GUtilData data;
+
+    return G_LIKELY(tag) ? ndef_lang_match(gutil_data_from_string(&data,
+        tag), lang) : NDEF_LANG_MATCH_NONE;
+}
+
+NdefRtdSp*
+ndef_rtd_sp_decode(
+    const GUtilData* payload)
+{
+    return G_LIKELY(payload) ? ndef_rtd_sp_decode_scratch(payload, NULL,
+        NULL, NULL) : NULL;
+}
+
+GBytes*
+ndef_rtd_sp_encode(
+    const char* uri,
+    const char* title,
+    const char* lang,
+    const char* type,
+    guint size,
+    NDEF_SP_ACT act,
+    const NdefMedia* icon)
+{
+    GByteArray* buf;
+    GBytes* uri_bytes;
+    GBytes* title_bytes = NULL;
+    GUtilData data[6];
+    const GUtilData* rec_type[6];
+    guint8 tnf[6];
+    guint8 act_value;
+    guint32 size_value;
+    guint i, n = 0;
+
+    if (G_UNLIKELY(!uri)) {
+        return NULL;
+    }
+
+    /* 3.3.1 The URI Record */
+    uri_bytes = ndef_uri_encode(uri);
+    tnf[n] = NDEF_TNF_WELL_KNOWN;
+    rec_type[n] = &ndef_rec_type_u;
+    gutil_data_from_bytes(data + (n++), uri_bytes);
+
+    /* 3.3.2 The Title Record */
+    if (title) {
+        title_bytes = ndef_rtd_text_encode(title, lang, NDEF_REC_T_ENC_UTF8);
+        if (!title_bytes) {
+            g_bytes_unref(uri_bytes);
+            return NULL;
+        }
+        tnf[n] = NDEF_TNF_WELL_KNOWN;
+        rec_type[n] = &ndef_rec_type_t;
+        gutil_data_from_bytes(data + (n++), title_bytes);
+    }
+
+    /* 3.3.3 The Recommended Action Record */
+    if (act != NDEF_SP_ACT_DEFAULT) {
+        act_value = (guint8)act;
+        tnf[n] = NDEF_TNF_WELL_KNOWN;
+        rec_type[n] = &ndef_sp_type_act;
+        data[n].bytes = &act_value;
+        data[n++].size = sizeof(act_value);
+    }
+
+    /* 3.3.5 The Size Record */
+    if (size) {
+        size_value = GUINT32_TO_BE(size);
+        tnf[n] = NDEF_TNF_WELL_KNOWN;
+        rec_type[n] = &ndef_sp_type_s;
+        data[n].bytes = (const guint8*)&size_value;
+        data[n++].size = sizeof(size_value);
+    }
+
+    /* 3.3.6 The Type Record */
+    if (type) {
+        tnf[n] = NDEF_TNF_WELL_KNOWN;
+        rec_type[n] = &ndef_sp_type_t;
+        gutil_data_from_string(data + (n++), type);
+    }
+
+    /* 3.3.4 The Icon Record */
+    if (icon && ndef_valid_mediatype_str(icon->type, FALSE)) {
+        tnf[n] = NDEF_TNF_MEDIA_TYPE;
+        rec_type[n] = NULL;
+        data[n++] = icon->data;
+    }
+
+    /* Put it all together */
+    buf = g_byte_array_new();
+    for (i = 0; i < n; i++) {
+        GUtilData media_type;
+        const GUtilData* t = rec_type[i] ? rec_type[i] :
+            gutil_data_from_string(&media_type, icon->type);
+
+        if (!ndef_rec_append(buf, tnf[i] | (i ? 0 : NDEF_HDR_MB) |
+            ((i + 1 < n) ? 0 : NDEF_HDR_ME), t, NULL, data + i)) {
+            break;
+        }
+    }
+
+    g_bytes_unref(uri_bytes);
+    if (title_bytes) {
+        g_bytes_unref(title_bytes);
+    }
+    if (i < n) {
+        /* Something didn't fit */
+        g_byte_array_free(buf, TRUE);
+        return NULL;
+    }
+    return g_byte_array_free_to_bytes(buf);
+}
+
+/*==========================================================================*
+ * Internal interface
+ *==========================================================================*/
+
+gboolean
+ndef_rtd_text_parse(
+    const GUtilData* payload,
+    GUtilData* lang,
+    GUtilData* text,
+    NDEF_REC_T_ENC* enc)
+{
+    if (ndef_text_split(payload, lang, text, enc)) {
+        if (*enc != NDEF_REC_T_ENC_UTF8 ||
+            g_utf8_validate((const char*)text->bytes, text->size, NULL)) {
+            return TRUE;
+        }
+        ndef_reject(payload, lang->size + 1, "Invalid UTF-8 text");
+    } else {
+        ndef_reject(payload, 0, "Invalid Text record language");
+    }
+    return FALSE;
+}
+
+NdefRtdText*
+ndef_rtd_text_decode_scratch(
+    const GUtilData* payload,
+    NdefScratch* scratch)
+{
+    NdefRtdText* rtd = NULL;
+    GUtilData lang, text, utf8;
+    NDEF_REC_T_ENC enc;
+
+    if (ndef_rtd_text_parse(payload, &lang, &text, &enc)) {
+        if (enc == NDEF_REC_T_ENC_UTF8) {
+            /* No conversion needed, the text has been validated */
+            rtd = ndef_rtd_text_alloc(&lang, &text, enc);
+        } else {
+            NdefScratch tmp;
+
+            if (!scratch) {
+                ndef_scratch_init(scratch = &tmp);
+            }
+            if (ndef_rtd_text_utf8(scratch, payload, &lang, &text, enc,
+                &utf8)) {
+                rtd = ndef_rtd_text_alloc(&lang, &utf8, enc);
+            }
+            if (scratch == &tmp) {
+                ndef_scratch_clear(&tmp);
+            }
+        }
+    }
+    return rtd;
+}
+
+NdefRtdSp*
+ndef_rtd_sp_decode_scratch(
+    const GUtilData* payload,
+    NdefScratch* scratch,
+    NdefRtdAllocFunc alloc,
+    gpointer user_data)
+{
+    static const NdefMsgVisitor visitor = {
+        .uri = ndef_rtd_sp_uri,
+        .text = ndef_rtd_sp_text,
+        .sp_act = ndef_rtd_sp_act,
+        .sp_size = ndef_rtd_sp_size,
+        .sp_type = ndef_rtd_sp_type,
+        .sp_icon = ndef_rtd_sp_icon,
+        .other = ndef_rtd_sp_other
+    };
+    NdefRtdSp* sp = NULL;
+    NdefRtdSpDecoder dec;
+    NdefScratch tmp;
+
+    if (!scratch) {
+        ndef_scratch_init(scratch = &tmp);
+    }
+
+    /* The content of a Smart Poster payload is an NDEF message */
+    memset(&dec, 0, sizeof(dec));
+    dec.payload = payload;
+    dec.scratch = scratch;
+    dec.act = NDEF_SP_ACT_DEFAULT;
+    if (!ndef_msg_visit_sp(payload, &visitor, &dec) && !dec.stop) {
+        NdefMsgIter it;
+
+        /* Keep what's been decoded, just find where the garbage is */
+        ndef_msg_iter_init(&it, payload);
+        while (ndef_msg_iter_next(&it, NULL));
+        ndef_reject(payload, it.offset, "Garbage in SmartPoster content");
+    }
+
+    /* URI record is the only required one. */
+    if (dec.stop) {
+        /* More than one URI record */
+    } else if (dec.uri) {
+        /* The URI is assembled right in the allocated block */
+        sp = ndef_rtd_sp_alloc(&dec.prefix, &dec.suffix,
+            dec.title ? &dec.title_utf8 : NULL, &dec.lang,
+            dec.type.size ? &dec.type : NULL, dec.size, dec.act,
+            dec.icon_type.size ? &dec.icon_type : NULL, &dec.icon_data,
+            alloc, user_data);
+    } else {
+        NDEF_WARN("SmartPoster NDEF is missing URI record");
+        ndef_reject(payload, 0, "Missing SmartPoster URI");
+    }
+
+    if (scratch == &tmp) {
+        ndef_scratch_clear(&tmp);
+    }
+    g_free(dec.system);
+    return sp;
+}
+
+NdefRtdText*
+ndef_rtd_text_new(
+    const char* text,
+    const char* lang,
+    NDEF_REC_T_ENC enc)
+{
+    GUtilData lang_data, text_data;
+
+    return ndef_rtd_text_alloc(gutil_data_from_string(&lang_data, lang),
+        gutil_data_from_string(&text_data, text), enc);
+}
+
+NdefRtdSp*
+ndef_rtd_sp_new(
+    const char* uri,
+    const char* title,
+    const char* lang,
+    const char* type,
+    guint size,
+    NDEF_SP_ACT act,
+    const NdefMedia* icon,
+    NdefRtdAllocFunc alloc,
+    gpointer user_data)
+{
+    GUtilData uri_data, title_data, lang_data, type_data, icon_type;
+
+    /* Same as what ndef_rtd_sp_encode() puts into the payload */
+    if (!ndef_valid_mediatype_str(icon ? icon->type : NULL, FALSE)) {
+        icon = NULL;
+    }
+    return ndef_rtd_sp_alloc(NULL, gutil_data_from_string(&uri_data, uri),
+        title ? gutil_data_from_string(&title_data, title) : NULL,
+        gutil_data_from_string(&lang_data, lang),
+        type ? gutil_data_from_string(&type_data, type) : NULL, size, act,
+        icon ? gutil_data_from_string(&icon_type, icon->type) : NULL,
+        icon ? &icon->data : NULL, alloc, user_data);
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
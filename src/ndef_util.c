@@ -43,6 +43,86 @@
 #include <gutil_misc.h>
 #include <gutil_macros.h>
 
+GLOG_MODULE_DEFINE("ndef");
+
+static guint ndef_log_limit_interval_ms = 10000;
+static guint ndef_log_limit_burst = 3;
+
+G_LOCK_DEFINE_STATIC(ndef_log_limit);
+
+void
+ndef_log_set_limit(
+    guint interval_ms,
+    guint burst)
+{
+    G_LOCK(ndef_log_limit);
+    ndef_log_limit_interval_ms = interval_ms;
+    ndef_log_limit_burst = burst;
+    G_UNLOCK(ndef_log_limit);
+}
+
+void
+ndef_log_get_limit(
+    guint* interval_ms,
+    guint* burst)
+{
+    G_LOCK(ndef_log_limit);
+    if (interval_ms) {
+        *interval_ms = ndef_log_limit_interval_ms;
+    }
+    if (burst) {
+        *burst = ndef_log_limit_burst;
+    }
+    G_UNLOCK(ndef_log_limit);
+}
+
+gboolean
+ndef_log_limit_check(
+    NdefLogLimiter* limiter)
+{
+    GLogModule* log = &GLOG_MODULE_NAME;
+
+    if (!gutil_log_enabled(log, GLOG_LEVEL_WARN)) {
+        return FALSE;
+    } else if (gutil_log_enabled(log, GLOG_LEVEL_DEBUG)) {
+        return TRUE;
+    } else {
+        const gint64 now = g_get_monotonic_time();
+        guint suppressed = 0;
+        gboolean ok;
+
+        G_LOCK(ndef_log_limit);
+        if (!ndef_log_limit_interval_ms) {
+            ok = TRUE;
+        } else {
+            const gint64 interval = (gint64)
+                ndef_log_limit_interval_ms * 1000;
+
+            if (!limiter->start || (now - limiter->start) >= interval) {
+                /* New interval */
+                suppressed = limiter->suppressed;
+                limiter->start = now;
+                limiter->count = 0;
+                limiter->suppressed = 0;
+            }
+            if (limiter->count < ndef_log_limit_burst) {
+                limiter->count++;
+                ok = TRUE;
+            } else {
+                limiter->suppressed++;
+                ok = FALSE;
+            }
+        }
+        G_UNLOCK(ndef_log_limit);
+
+        if (suppressed) {
+            gutil_log(log, GLOG_LEVEL_WARN, "Suppressed %u warning(s) "
+                "\"%s\"", suppressed, limiter->what);
+        }
+        return ok;
+    }
+}
+
 void
 ndef_hexdump(
     const void* data,
@@ -145,6 +225,127 @@ ndef_system_language(
     return NULL;
 }
 
+/* System language as language[-territory] tag, "en" if it's unknown */
+char*
+ndef_default_lang_tag(
+    void)
+{
+    NdefLanguage* system = ndef_system_language();
+
+    if (system) {
+        char* tag = system->territory ?
+            g_strconcat(system->language, "-", system->territory, NULL) :
+            g_strdup(system->language);
+
+        g_free(system);
+        GDEBUG("System language: %s", tag);
+        return tag;
+    }
+    return g_strdup("en");
+}
+
+/* See RFC 2045, section 5.1 "Syntax of the Content-Type Header Field" */
+
+static
+gboolean
+ndef_is_token_char(
+    guint8 c)
+{
+    /*  token := 1*<any (US-ASCII) CHAR except SPACE, CTLs, or tspecials> */
+    if (c < 0x80) {
+        static const guint32 token_chars[] = {
+            0x00000000, /* ................................ */
+            0x03ff6cfa, /*  !"#$%&'()*+,-./0123456789:;<=>? */
+            0xc7fffffe, /* @ABCDEFGHIJKLMNOPQRSTUVWXYZ[\]^_ */
+            0x7fffffff  /* `abcdefghijklmnopqrstuvwxyz{|}~. */
+        };
+        if (token_chars[c/32] & (1 << (c % 32))) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+gboolean
+ndef_valid_mediatype(
+    const GUtilData* type,
+    gboolean wildcard)
+{
+    if (type) {
+        guint i = 0;
+
+        if (type->size > 0) {
+            if (type->bytes[i] == (guint8)'*') {
+                if (wildcard) {
+                    i++;
+                } else {
+                    return FALSE;
+                }
+            } else {
+                while (i < type->size && ndef_is_token_char(type->bytes[i])) {
+                    i++;
+                }
+            }
+        }
+        if (i > 0 && (i + 1) < type->size && type->bytes[i] == (guint8)'/') {
+            i++;
+            if ((i + 1) == type->size && type->bytes[i] == (guint8)'*') {
+                return wildcard;
+            } else {
+                while (i < type->size && ndef_is_token_char(type->bytes[i])) {
+                    i++;
+                }
+                if (i == type->size) {
+                    return !wildcard;
+                }
+            }
+        }
+    }
+    return FALSE;
+}
+
+gboolean
+ndef_valid_mediatype_str(
+    const char* type,
+    gboolean wildcard)
+{
+    GUtilData data;
+
+    return type && ndef_valid_mediatype(gutil_data_from_string(&data, type),
+        wildcard);
+}
+
+/* 32-bit FNV-1a, the value is mixed in little-endian byte order */
+guint
+ndef_hash_uint(
+    guint hash,
+    guint32 value)
+{
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        hash = (hash ^ (value & 0xff)) * NDEF_HASH_PRIME;
+        value >>= 8;
+    }
+    return hash;
+}
+
+/* Mixes in the length and then the contents */
+guint
+ndef_hash_data(
+    guint hash,
+    const GUtilData* data)
+{
+    const guint8* ptr = data->bytes;
+    const guint8* end = ptr + data->size;
+
+    hash = ndef_hash_uint(hash, data->size);
+    while (ptr < end) {
+        hash = (hash ^ *ptr++) * NDEF_HASH_PRIME;
+    }
+    return hash;
+}
+
 /*
  * Local Variables:
  * mode: C
@@ -40,8 +40,112 @@
 #ifndef NDEF_UTIL_PRIVATE_H
 #define NDEF_UTIL_PRIVATE_H
 
+#include "ndef_msg.h"
+#include "ndef_rtd.h"
 #include "ndef_util.h"
 
+/* Pre-parsed NDEF record */
+typedef struct ndef_data {
+    GUtilData rec;
+    guint type_offset;
+    guint type_length;
+    guint id_length;
+    guint payload_length;
+} NdefData;
+
+/*
+ * Scratch memory reused by the decoders, one per thread. The UTF-16
+ * converters are opened on demand and kept open, the output buffer
+ * only grows.
+ */
+typedef struct ndef_scratch {
+    GIConv utf16[2];    /* UTF-16LE and UTF-16BE to UTF-8 */
+    char* buf;
+    gsize size;
+} NdefScratch;
+
+/*
+ * Allocator of the decoded data blocks. The memory must be zeroed and
+ * aligned for pointers. g_malloc0() is used if no allocator is given.
+ */
+typedef
+gpointer
+(*NdefRtdAllocFunc)(
+    gsize size,
+    gpointer user_data);
+
+extern const GUtilData ndef_rec_type_u G_GNUC_INTERNAL; /* "U" */
+extern const GUtilData ndef_rec_type_t G_GNUC_INTERNAL; /* "T" */
+extern const GUtilData ndef_rec_type_sp G_GNUC_INTERNAL; /* "Sp" */
+
+/* Smart Poster content record types */
+extern const GUtilData ndef_sp_type_act G_GNUC_INTERNAL; /* "act" */
+extern const GUtilData ndef_sp_type_s G_GNUC_INTERNAL; /* "s" */
+extern const GUtilData ndef_sp_type_t G_GNUC_INTERNAL; /* "t" */
+
+gboolean
+ndef_data_parse(
+    GUtilData* block,
+    NdefData* ndef,
+    const char** error)
+    G_GNUC_INTERNAL;
+
+gboolean
+ndef_type(
+    const NdefData* data,
+    GUtilData* type)
+    G_GNUC_INTERNAL;
+
+gboolean
+ndef_payload(
+    const NdefData* data,
+    GUtilData* payload)
+    G_GNUC_INTERNAL;
+
+/* Visits the content of a Smart Poster */
+gboolean
+ndef_msg_visit_sp(
+    const GUtilData* content,
+    const NdefMsgVisitor* visitor,
+    gpointer user_data)
+    G_GNUC_INTERNAL;
+
+#define NDEF_REC_HEADER_MAX (7)
+
+guint
+ndef_rec_header(
+    guint8* head,
+    guint8 hdr,
+    gsize type_len,
+    gsize id_len,
+    gsize payload_len)
+    G_GNUC_INTERNAL;
+
+gboolean
+ndef_rec_append(
+    GByteArray* buf,
+    guint8 hdr,
+    const GUtilData* type,
+    const GUtilData* id,
+    const GUtilData* payload)
+    G_GNUC_INTERNAL;
+
+/* 32-bit FNV-1a */
+#define NDEF_HASH_INIT (2166136261u)
+#define NDEF_HASH_PRIME (16777619u)
+
+guint
+ndef_hash_uint(
+    guint hash,
+    guint32 value)
+    G_GNUC_INTERNAL;
+
+guint
+ndef_hash_data(
+    guint hash,
+    const GUtilData* data)
+    G_GNUC_INTERNAL;
+
 void
 ndef_hexdump(
     const void* data,
@@ -58,6 +162,129 @@ ndef_system_locale(
     void)
     G_GNUC_INTERNAL;
 
+char*
+ndef_default_lang_tag(
+    void)
+    G_GNUC_INTERNAL;
+
+guint8
+ndef_uri_prefix(
+    const char* uri,
+    gsize len,
+    gsize* prefix_len)
+    G_GNUC_INTERNAL;
+
+GBytes*
+ndef_uri_encode(
+    const char* uri)
+    G_GNUC_INTERNAL;
+
+gboolean
+ndef_uri_split(
+    const GUtilData* payload,
+    GUtilData* prefix,
+    GUtilData* suffix)
+    G_GNUC_INTERNAL;
+
+#define NDEF_TEXT_LANG_MAX (0x3f)
+
+GBytes*
+ndef_text_encode(
+    const char* text,
+    const char* lang,
+    NDEF_REC_T_ENC enc)
+    G_GNUC_INTERNAL;
+
+gboolean
+ndef_text_split(
+    const GUtilData* payload,
+    GUtilData* lang,
+    GUtilData* text,
+    NDEF_REC_T_ENC* enc)
+    G_GNUC_INTERNAL;
+
+char*
+ndef_text_decode(
+    const GUtilData* text,
+    NDEF_REC_T_ENC enc)
+    G_GNUC_INTERNAL;
+
+void
+ndef_scratch_init(
+    NdefScratch* scratch)
+    G_GNUC_INTERNAL;
+
+void
+ndef_scratch_clear(
+    NdefScratch* scratch)
+    G_GNUC_INTERNAL;
+
+/* The result is NUL-terminated and valid until the next call */
+gboolean
+ndef_scratch_utf16(
+    NdefScratch* scratch,
+    const GUtilData* text,
+    NDEF_REC_T_ENC enc,
+    GUtilData* utf8)
+    G_GNUC_INTERNAL;
+
+NDEF_LANG_MATCH
+ndef_lang_match(
+    const GUtilData* tag,
+    const NdefLanguage* lang)
+    G_GNUC_INTERNAL;
+
+/* Like ndef_text_split() but also validates UTF-8 text and rejects */
+gboolean
+ndef_rtd_text_parse(
+    const GUtilData* payload,
+    GUtilData* lang,
+    GUtilData* text,
+    NDEF_REC_T_ENC* enc)
+    G_GNUC_INTERNAL;
+
+/* Same as the public ones but with the scratch memory (optional) */
+NdefRtdText*
+ndef_rtd_text_decode_scratch(
+    const GUtilData* payload,
+    NdefScratch* scratch)
+    G_GNUC_INTERNAL;
+
+NdefRtdSp*
+ndef_rtd_sp_decode_scratch(
+    const GUtilData* payload,
+    NdefScratch* scratch,
+    NdefRtdAllocFunc alloc,
+    gpointer user_data)
+    G_GNUC_INTERNAL;
+
+NdefRtdText*
+ndef_rtd_text_new(
+    const char* text,
+    const char* lang,
+    NDEF_REC_T_ENC enc)
+    G_GNUC_INTERNAL;
+
+NdefRtdSp*
+ndef_rtd_sp_new(
+    const char* uri,
+    const char* title,
+    const char* lang, /* Ignored if there's no title */
+    const char* type,
+    guint size,
+    NDEF_SP_ACT act,
+    const NdefMedia* icon,
+    NdefRtdAllocFunc alloc,
+    gpointer user_data)
+    G_GNUC_INTERNAL;
+
+void
+ndef_reject(
+    const GUtilData* input,
+    gsize offset,
+    const char* reason)
+    G_GNUC_INTERNAL;
+
 #endif /* NDEF_UTIL_PRIVATE_H */
 
 /*
@@ -0,0 +1,359 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "test_common.h"
+
+#include "ndef_async.h"
+
+static TestOpt test_opt;
+
+static const guint8 test_uri_rec[] = {
+    0xd1,           /* NDEF record header (MB=1, ME=1, SR=1, TNF=0x01) */
+    0x01,           /* Length of the record type */
+    0x02,           /* Length of the record payload */
+    'U',            /* Record type: 'U' (URI) */
+    0x01, 'x'       /* http://www.x */
+};
+
+static const guint8 test_uri_tlv[] = {
+    0x03, 0x06,     /* NDEF Message TLV */
+    0xd1, 0x01, 0x02, 'U', 0x01, 'x',
+    0xfe            /* Terminator TLV */
+};
+
+/* Stubs */
+
+const char*
+ndef_system_locale(
+    void)
+{
+    return NULL;
+}
+
+/* Utilities */
+
+typedef struct test_async {
+    GMainLoop* loop;
+    GAsyncResult* result;
+} TestAsync;
+
+static
+void
+test_async_done(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestAsync* test = user_data;
+
+    g_assert(!object);
+    g_assert(!test->result);
+    test->result = g_object_ref(result);
+    g_main_loop_quit(test->loop);
+}
+
+static
+void
+test_async_init(
+    TestAsync* test)
+{
+    test->loop = g_main_loop_new(NULL, FALSE);
+    test->result = NULL;
+}
+
+static
+GAsyncResult*
+test_async_wait(
+    TestAsync* test)
+{
+    g_main_loop_run(test->loop);
+    g_assert(test->result);
+    return test->result;
+}
+
+static
+void
+test_async_deinit(
+    TestAsync* test)
+{
+    g_object_unref(test->result);
+    g_main_loop_unref(test->loop);
+}
+
+/*==========================================================================*
+ * parse
+ *==========================================================================*/
+
+static
+void
+test_parse(
+    void)
+{
+    static const guint8 garbage[] = { 0x00 };
+    TestAsync test;
+    GUtilData data;
+    GError* error = NULL;
+    NdefRec* rec;
+
+    test_async_init(&test);
+    TEST_BYTES_SET(data, test_uri_rec);
+    ndef_rec_new_async(&data, NULL, test_async_done, &test);
+    rec = ndef_rec_new_finish(test_async_wait(&test), &error);
+    g_assert(!error);
+    g_assert(NDEF_IS_REC_U(rec));
+    g_assert_cmpstr(NDEF_REC_U(rec)->uri, == ,"http://www.x");
+    ndef_rec_unref(rec);
+    test_async_deinit(&test);
+
+    /* Invalid data */
+    test_async_init(&test);
+    TEST_BYTES_SET(data, garbage);
+    ndef_rec_new_async(&data, NULL, test_async_done, &test);
+    g_assert(!ndef_rec_new_finish(test_async_wait(&test), &error));
+    g_assert_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+    g_clear_error(&error);
+    test_async_deinit(&test);
+
+    /* No data at all */
+    test_async_init(&test);
+    ndef_rec_new_async(NULL, NULL, test_async_done, &test);
+    g_assert(!ndef_rec_new_finish(test_async_wait(&test), &error));
+    g_assert_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+    g_clear_error(&error);
+    test_async_deinit(&test);
+}
+
+/*==========================================================================*
+ * tlv
+ *==========================================================================*/
+
+static
+void
+test_tlv(
+    void)
+{
+    TestAsync test;
+    GUtilData data;
+    GError* error = NULL;
+    NdefRec* rec;
+
+    test_async_init(&test);
+    TEST_BYTES_SET(data, test_uri_tlv);
+    ndef_rec_new_from_tlv_async(&data, NULL, test_async_done, &test);
+
+    /* Wrong finish function */
+    g_assert(!ndef_rec_new_finish(test_async_wait(&test), NULL));
+
+    rec = ndef_rec_new_from_tlv_finish(test.result, &error);
+    g_assert(!error);
+    g_assert(NDEF_IS_REC_U(rec));
+    g_assert_cmpstr(NDEF_REC_U(rec)->uri, == ,"http://www.x");
+    ndef_rec_unref(rec);
+    test_async_deinit(&test);
+}
+
+/*==========================================================================*
+ * uri
+ *==========================================================================*/
+
+static
+void
+test_uri(
+    void)
+{
+    TestAsync test;
+    GError* error = NULL;
+    NdefRecU* rec;
+
+    test_async_init(&test);
+    ndef_rec_u_new_async("http://www.x", NULL, test_async_done, &test);
+    rec = ndef_rec_u_new_finish(test_async_wait(&test), &error);
+    g_assert(!error);
+    g_assert(rec);
+    g_assert_cmpuint(rec->rec.raw.size, == ,sizeof(test_uri_rec));
+    g_assert(!memcmp(rec->rec.raw.bytes, test_uri_rec,
+        sizeof(test_uri_rec)));
+    ndef_rec_unref(&rec->rec);
+    test_async_deinit(&test);
+
+    test_async_init(&test);
+    ndef_rec_u_new_async(NULL, NULL, test_async_done, &test);
+    g_assert(!ndef_rec_u_new_finish(test_async_wait(&test), &error));
+    g_assert_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT);
+    g_clear_error(&error);
+    test_async_deinit(&test);
+}
+
+/*==========================================================================*
+ * text
+ *==========================================================================*/
+
+static
+void
+test_text(
+    void)
+{
+    TestAsync test;
+    GError* error = NULL;
+    NdefRecT* rec;
+
+    test_async_init(&test);
+    ndef_rec_t_new_async("y", "fi", NDEF_REC_T_ENC_UTF16BE, NULL,
+        test_async_done, &test);
+    rec = ndef_rec_t_new_finish(test_async_wait(&test), &error);
+    g_assert(!error);
+    g_assert(rec);
+    g_assert_cmpstr(rec->lang, == ,"fi");
+    g_assert_cmpstr(rec->text, == ,"y");
+    ndef_rec_unref(&rec->rec);
+    test_async_deinit(&test);
+
+    /* Default language and empty text */
+    test_async_init(&test);
+    ndef_rec_t_new_async(NULL, NULL, NDEF_REC_T_ENC_UTF8, NULL,
+        test_async_done, &test);
+    rec = ndef_rec_t_new_finish(test_async_wait(&test), &error);
+    g_assert(!error);
+    g_assert(rec);
+    g_assert_cmpstr(rec->lang, == ,"en");
+    g_assert_cmpstr(rec->text, == ,"");
+    ndef_rec_unref(&rec->rec);
+    test_async_deinit(&test);
+}
+
+/*==========================================================================*
+ * sp
+ *==========================================================================*/
+
+static
+void
+test_sp(
+    void)
+{
+    static const guint8 icon_data[] = { 0x01, 0x02, 0x03 };
+    TestAsync test;
+    GError* error = NULL;
+    NdefMedia icon;
+    NdefRecSp* rec;
+
+    memset(&icon, 0, sizeof(icon));
+    icon.type = "image/png";
+    TEST_BYTES_SET(icon.data, icon_data);
+
+    test_async_init(&test);
+    ndef_rec_sp_new_async("http://www.x", "Title", NULL, "text/html", 10,
+        NDEF_SP_ACT_OPEN, &icon, NULL, test_async_done, &test);
+    rec = ndef_rec_sp_new_finish(test_async_wait(&test), &error);
+    g_assert(!error);
+    g_assert(rec);
+    g_assert_cmpstr(rec->uri, == ,"http://www.x");
+    g_assert_cmpstr(rec->title, == ,"Title");
+    g_assert_cmpstr(rec->lang, == ,"en");
+    g_assert_cmpstr(rec->type, == ,"text/html");
+    g_assert_cmpuint(rec->size, == ,10);
+    g_assert_cmpint(rec->act, == ,NDEF_SP_ACT_OPEN);
+    g_assert(rec->icon);
+    g_assert_cmpstr(rec->icon->type, == ,"image/png");
+    g_assert_cmpuint(rec->icon->data.size, == ,sizeof(icon_data));
+    g_assert(!memcmp(rec->icon->data.bytes, icon_data, sizeof(icon_data)));
+    ndef_rec_unref(&rec->rec);
+    test_async_deinit(&test);
+
+    test_async_init(&test);
+    ndef_rec_sp_new_async(NULL, NULL, NULL, NULL, 0, NDEF_SP_ACT_DEFAULT,
+        NULL, NULL, test_async_done, &test);
+    g_assert(!ndef_rec_sp_new_finish(test_async_wait(&test), &error));
+    g_assert_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT);
+    g_clear_error(&error);
+    test_async_deinit(&test);
+}
+
+/*==========================================================================*
+ * cancel
+ *==========================================================================*/
+
+static
+void
+test_cancel(
+    void)
+{
+    GCancellable* cancel = g_cancellable_new();
+    TestAsync test;
+    GUtilData data;
+    GError* error = NULL;
+
+    test_async_init(&test);
+    TEST_BYTES_SET(data, test_uri_rec);
+    g_cancellable_cancel(cancel);
+    ndef_rec_new_async(&data, cancel, test_async_done, &test);
+    g_assert(!ndef_rec_new_finish(test_async_wait(&test), &error));
+    g_assert_error(error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+    g_clear_error(&error);
+    test_async_deinit(&test);
+    g_object_unref(cancel);
+}
+
+/*==========================================================================*
+ * Common
+ *==========================================================================*/
+
+#define TEST_(name) "/ndef_async/" name
+
+int main(int argc, char* argv[])
+{
+    G_GNUC_BEGIN_IGNORE_DEPRECATIONS;
+    g_type_init();
+    G_GNUC_END_IGNORE_DEPRECATIONS;
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("parse"), test_parse);
+    g_test_add_func(TEST_("tlv"), test_tlv);
+    g_test_add_func(TEST_("uri"), test_uri);
+    g_test_add_func(TEST_("text"), test_text);
+    g_test_add_func(TEST_("sp"), test_sp);
+    g_test_add_func(TEST_("cancel"), test_cancel);
+    test_init(&test_opt, argc, argv);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "test_common.h"
+
+#include "ndef_rec.h"
+
+#include <gutil_log.h>
+
+static TestOpt test_opt;
+
+/*
+ * The first parse after ndef_init() must not be much slower than the
+ * steady state. Very short times are rounded up to TEST_MIN_TIME_US
+ * to filter out the noise. The timing is only checked in perf mode
+ * (-m perf), otherwise it's just logged.
+ */
+#define TEST_RUNS (100)
+#define TEST_SLACK (5)
+#define TEST_MIN_TIME_US (2000)
+
+/* URI, UTF-16 Text, SmartPoster with UTF-16 title and a media type */
+static const guint8 test_msg[] = {
+    0x91, 0x01, 0x04, 'U', 0x01, 'a', '.', 'b',
+    0x11, 0x01, 0x09, 'T', 0x82, 'e', 'n', 0xff, 0xfe, 'H', 0x00, 'i', 0x00,
+    0x11, 0x02, 0x13, 'S', 'p',
+    0x91, 0x01, 0x04, 'U', 0x01, 'a', '.', 'b',
+    0x51, 0x01, 0x07, 'T', 0x82, 'e', 'n', 0x00, 'H', 0x00, 'i',
+    0x52, 0x0a, 0x01, 't', 'e', 'x', 't', '/', 'p', 'l', 'a', 'i', 'n', 'x'
+};
+
+/* Stubs */
+
+const char*
+ndef_system_locale(
+    void)
+{
+    return "en_US.UTF-8";
+}
+
+/* Utilities */
+
+static
+gint64
+test_parse(
+    void)
+{
+    const gint64 start = g_get_monotonic_time();
+    NdefRec* rec;
+    GUtilData data;
+    gint64 t;
+
+    TEST_BYTES_SET(data, test_msg);
+    rec = ndef_rec_new_opt(&data, NULL, NULL);
+    t = g_get_monotonic_time() - start;
+
+    g_assert(NDEF_IS_REC_U(rec));
+    g_assert(NDEF_IS_REC_T(rec->next));
+    g_assert_cmpstr(NDEF_REC_T(rec->next)->text, == ,"Hi");
+    g_assert(NDEF_IS_REC_SP(rec->next->next));
+    g_assert_cmpstr(NDEF_REC_SP(rec->next->next)->title, == ,"Hi");
+    g_assert_cmpint(rec->next->next->next->tnf, == ,NDEF_TNF_MEDIA_TYPE);
+    g_assert(!rec->next->next->next->next);
+    ndef_rec_unref(rec);
+    return t;
+}
+
+/*==========================================================================*
+ * latency
+ *==========================================================================*/
+
+static
+void
+test_latency(
+    void)
+{
+    gint64 start = g_get_monotonic_time();
+    gint64 init, first, best = 0;
+    int i;
+
+    ndef_init();
+    init = g_get_monotonic_time() - start;
+    first = test_parse();
+    for (i = 0; i < TEST_RUNS; i++) {
+        const gint64 t = test_parse();
+
+        if (!i || t < best) {
+            best = t;
+        }
+    }
+
+    GDEBUG("init %d us, first %d us, steady %d us", (int) init,
+        (int) first, (int) best);
+    if (g_test_perf()) {
+        g_assert_cmpint(first, <= ,MAX(best, TEST_MIN_TIME_US) *
+            TEST_SLACK);
+    }
+}
+
+/*==========================================================================*
+ * basic
+ *==========================================================================*/
+
+static
+void
+test_basic(
+    void)
+{
+    /* Repeated calls are fine */
+    ndef_init();
+    ndef_init();
+    g_assert(g_type_class_peek(NDEF_TYPE_REC));
+    g_assert(g_type_class_peek(NDEF_TYPE_REC_U));
+    g_assert(g_type_class_peek(NDEF_TYPE_REC_T));
+    g_assert(g_type_class_peek(NDEF_TYPE_REC_SP));
+}
+
+/*==========================================================================*
+ * Common
+ *==========================================================================*/
+
+#define TEST_(name) "/ndef_init/" name
+
+int main(int argc, char* argv[])
+{
+    G_GNUC_BEGIN_IGNORE_DEPRECATIONS;
+    g_type_init();
+    G_GNUC_END_IGNORE_DEPRECATIONS;
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("latency"), test_latency);
+    g_test_add_func(TEST_("basic"), test_basic);
+    test_init(&test_opt, argc, argv);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
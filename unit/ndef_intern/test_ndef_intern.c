@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "test_common.h"
+
+#include "ndef_util.h"
+
+#include <gutil_misc.h>
+
+static TestOpt test_opt;
+
+/*==========================================================================*
+ * null
+ *==========================================================================*/
+
+static
+void
+test_null(
+    void)
+{
+    static const guint8 nul[] = { 'a', 0, 'b' };
+    GUtilData data;
+
+    g_assert(!ndef_intern(NULL));
+    TEST_BYTES_SET(data, nul);
+    g_assert(!ndef_intern(&data));
+}
+
+/*==========================================================================*
+ * basic
+ *==========================================================================*/
+
+static
+void
+test_basic(
+    void)
+{
+    static const guint8 en[] = { 'e', 'n', '-', 'U', 'S' };
+    static const guint8 empty[] = { 0 };
+    GUtilData data;
+    const char* str;
+
+    /* The bytes don't have to be NUL-terminated */
+    TEST_BYTES_SET(data, en);
+    data.size = 2;
+    str = ndef_intern(&data);
+    g_assert_cmpstr(str, == ,"en");
+    g_assert(ndef_intern(gutil_data_from_string(&data, "en")) == str);
+    g_assert(ndef_intern(gutil_data_from_string(&data, "en-US")) != str);
+    TEST_BYTES_SET(data, en);
+    g_assert_cmpstr(ndef_intern(&data), == ,"en-US");
+    g_assert(ndef_intern(&data) ==
+        ndef_intern(gutil_data_from_string(&data, "en-US")));
+
+    /* Empty string */
+    TEST_BYTES_SET(data, empty);
+    data.size = 0;
+    str = ndef_intern(&data);
+    g_assert_cmpstr(str, == ,"");
+    g_assert(ndef_intern(gutil_data_from_string(&data, "")) == str);
+}
+
+/*==========================================================================*
+ * limits
+ *==========================================================================*/
+
+static
+void
+test_limits(
+    void)
+{
+    char buf[257];
+    GUtilData data;
+    const char* str;
+    guint i;
+
+    /* Too long */
+    memset(buf, 'x', sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = 0;
+    g_assert(!ndef_intern(gutil_data_from_string(&data, buf)));
+    buf[255] = 0;
+    g_assert(ndef_intern(gutil_data_from_string(&data, buf)));
+
+    /* Fill the table */
+    str = ndef_intern(gutil_data_from_string(&data, "first"));
+    g_assert(str);
+    for (i = 0; i < 2000; i++) {
+        char* tmp = g_strdup_printf("%u", i);
+
+        ndef_intern(gutil_data_from_string(&data, tmp));
+        g_free(tmp);
+    }
+    g_assert(!ndef_intern(gutil_data_from_string(&data, "nope")));
+
+    /* Existing strings are still there */
+    g_assert(ndef_intern(gutil_data_from_string(&data, "first")) == str);
+}
+
+/*==========================================================================*
+ * thread
+ *==========================================================================*/
+
+#define TEST_THREADS (4)
+
+static
+gpointer
+test_thread_proc(
+    gpointer data)
+{
+    GUtilData tag;
+
+    return (gpointer) ndef_intern(gutil_data_from_string(&tag, "fi"));
+}
+
+static
+void
+test_thread(
+    void)
+{
+    GThread* thread[TEST_THREADS];
+    GUtilData data;
+    const char* str;
+    int i;
+
+    for (i = 0; i < TEST_THREADS; i++) {
+        thread[i] = g_thread_new("test", test_thread_proc, NULL);
+    }
+    str = ndef_intern(gutil_data_from_string(&data, "fi"));
+    g_assert_cmpstr(str, == ,"fi");
+    for (i = 0; i < TEST_THREADS; i++) {
+        g_assert(g_thread_join(thread[i]) == str);
+    }
+}
+
+/*==========================================================================*
+ * Common
+ *==========================================================================*/
+
+#define TEST_(name) "/ndef_intern/" name
+
+int main(int argc, char* argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("null"), test_null);
+    g_test_add_func(TEST_("basic"), test_basic);
+    g_test_add_func(TEST_("thread"), test_thread);
+    g_test_add_func(TEST_("limits"), test_limits);
+    test_init(&test_opt, argc, argv);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,699 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "test_common.h"
+
+#include "ndef_msg.h"
+
+static TestOpt test_opt;
+
+/*==========================================================================*
+ * null
+ *==========================================================================*/
+
+static
+void
+test_null(
+    void)
+{
+    NdefMsgIter it;
+    NdefMsgRec rec;
+
+    /* NULL tolerance */
+    ndef_msg_iter_init(NULL, NULL);
+    g_assert(!ndef_msg_iter_next(NULL, NULL));
+    g_assert(!ndef_msg_iter_next(NULL, &rec));
+    ndef_msg_iter_init(&it, NULL);
+    g_assert(!ndef_msg_iter_next(&it, NULL));
+    g_assert(!ndef_msg_iter_next(&it, &rec));
+    g_assert_cmpuint(it.data.size, == ,0);
+    g_assert_cmpuint(it.offset, == ,0);
+}
+
+/*==========================================================================*
+ * records
+ *==========================================================================*/
+
+static
+void
+test_records(
+    void)
+{
+    static const guint8 data[] = {
+        0x99,                   /* MB,SR,IL,TNF=0x01 */
+        0x01, 0x02, 0x01,       /* Type, payload and id length */
+        'x',                    /* Type */
+        'i',                    /* ID */
+        0x01, 0x02,             /* Payload */
+        0x42,                   /* ME,TNF=0x02 (long record) */
+        0x03,                   /* Type length */
+        0x00, 0x00, 0x00, 0x01, /* Payload length */
+        'a', '/', 'b',          /* Type */
+        0x03                    /* Payload */
+    };
+    GUtilData msg;
+    NdefMsgIter it;
+    NdefMsgRec rec;
+
+    TEST_BYTES_SET(msg, data);
+    ndef_msg_iter_init(&it, &msg);
+
+    g_assert(ndef_msg_iter_next(&it, &rec));
+    g_assert_cmpuint(rec.hdr, == ,0x99);
+    g_assert_cmpint(rec.tnf, == ,NDEF_TNF_WELL_KNOWN);
+    g_assert(rec.raw.bytes == data);
+    g_assert_cmpuint(rec.raw.size, == ,8);
+    g_assert(rec.type.bytes == data + 4);
+    g_assert_cmpuint(rec.type.size, == ,1);
+    g_assert(rec.id.bytes == data + 5);
+    g_assert_cmpuint(rec.id.size, == ,1);
+    g_assert(rec.payload.bytes == data + 6);
+    g_assert_cmpuint(rec.payload.size, == ,2);
+    g_assert_cmpuint(it.offset, == ,8);
+
+    /* NULL rec is allowed, record is just skipped */
+    ndef_msg_iter_init(&it, &msg);
+    g_assert(ndef_msg_iter_next(&it, NULL));
+
+    g_assert(ndef_msg_iter_next(&it, &rec));
+    g_assert_cmpuint(rec.hdr, == ,0x42);
+    g_assert_cmpint(rec.tnf, == ,NDEF_TNF_MEDIA_TYPE);
+    g_assert(rec.raw.bytes == data + 8);
+    g_assert_cmpuint(rec.raw.size, == ,sizeof(data) - 8);
+    g_assert(rec.type.bytes == data + 14);
+    g_assert_cmpuint(rec.type.size, == ,3);
+    g_assert(!rec.id.size);
+    g_assert(rec.payload.bytes == data + 17);
+    g_assert_cmpuint(rec.payload.size, == ,1);
+    g_assert_cmpuint(it.offset, == ,sizeof(data));
+
+    /* The end */
+    g_assert(!ndef_msg_iter_next(&it, &rec));
+    g_assert(!rec.raw.bytes);
+    g_assert_cmpuint(it.data.size, == ,0);
+}
+
+/*==========================================================================*
+ * index
+ *==========================================================================*/
+
+static
+void
+test_index(
+    void)
+{
+    static const guint8 data[] = {
+        0x91, 0x01, 0x01, 'x', 0x00,
+        0x11, 0x01, 0x00, 'y',
+        0x51, 0x01, 0x02, 'z', 0x01, 0x02,
+        0x00                    /* Garbage */
+    };
+    NdefMsgIndex* index;
+    NdefMsgRec rec;
+    GByteArray* buf;
+    GUtilData msg;
+    guint i;
+
+    /* NULL tolerance */
+    g_assert(!ndef_msg_index_new(NULL));
+    g_assert(!ndef_msg_index_get(NULL, NULL, 0, NULL));
+    g_assert(!ndef_msg_index_get(NULL, NULL, 0, &rec));
+
+    TEST_BYTES_SET(msg, data);
+    index = ndef_msg_index_new(&msg);
+    g_assert(index);
+    g_assert_cmpuint(index->count, == ,3);
+    g_assert_cmpuint(index->entry[0].offset, == ,0);
+    g_assert_cmpuint(index->entry[0].size, == ,5);
+    g_assert_cmpuint(index->entry[1].offset, == ,5);
+    g_assert_cmpuint(index->entry[1].size, == ,4);
+    g_assert_cmpuint(index->entry[2].offset, == ,9);
+    g_assert_cmpuint(index->entry[2].size, == ,6);
+
+    g_assert(ndef_msg_index_get(index, &msg, 2, NULL));
+    g_assert(ndef_msg_index_get(index, &msg, 2, &rec));
+    g_assert(rec.raw.bytes == data + 9);
+    g_assert_cmpuint(rec.raw.size, == ,6);
+    g_assert_cmpuint(rec.type.size, == ,1);
+    g_assert_cmpint(rec.type.bytes[0], == ,'z');
+    g_assert(rec.payload.bytes == data + 13);
+    g_assert_cmpuint(rec.payload.size, == ,2);
+
+    g_assert(!ndef_msg_index_get(index, &msg, 3, &rec));
+    g_assert(!rec.raw.bytes);
+    g_assert(!ndef_msg_index_get(index, NULL, 0, &rec));
+
+    /* Wrong (too short) buffer */
+    msg.size = 10;
+    g_assert(!ndef_msg_index_get(index, &msg, 2, &rec));
+    g_free(index);
+
+    /* No records */
+    msg.size = 2;
+    g_assert(!ndef_msg_index_new(&msg));
+
+    /* Enough records to grow the table a few times */
+    buf = g_byte_array_new();
+    for (i = 0; i < 100; i++) {
+        const guint8 r[] = { 0x11, 0x01, 0x01, 'x', (guint8) i };
+
+        g_byte_array_append(buf, TEST_ARRAY_AND_SIZE(r));
+    }
+    msg.bytes = buf->data;
+    msg.size = buf->len;
+    index = ndef_msg_index_new(&msg);
+    g_assert(index);
+    g_assert_cmpuint(index->count, == ,100);
+    for (i = 0; i < index->count; i++) {
+        g_assert(ndef_msg_index_get(index, &msg, i, &rec));
+        g_assert_cmpuint(index->entry[i].offset, == ,5 * i);
+        g_assert_cmpuint(rec.payload.size, == ,1);
+        g_assert_cmpuint(rec.payload.bytes[0], == ,i);
+    }
+    g_free(index);
+    g_byte_array_free(buf, TRUE);
+}
+
+/*==========================================================================*
+ * pack
+ *==========================================================================*/
+
+static
+void
+test_pack(
+    void)
+{
+    static const guint8 data[] = {
+        0x99, 0x01, 0x01, 0x02, 'x', 'i', 'd', 0x01,
+        0x00                    /* Next record, not packed */
+    };
+    static const guint8 bad[] = { 0xd1, 0x01, 0x02, 'x', 0x00 };
+    NdefMsgRecPack* pack;
+    NdefMsgRec rec;
+    GUtilData raw;
+
+    /* NULL tolerance */
+    g_assert(!ndef_msg_rec_pack(NULL));
+    g_assert(!ndef_msg_rec_unpack(NULL, NULL));
+    memset(&rec, 0xff, sizeof(rec));
+    g_assert(!ndef_msg_rec_unpack(NULL, &rec));
+    g_assert(!rec.raw.bytes);
+
+    /* Invalid record */
+    TEST_BYTES_SET(raw, bad);
+    g_assert(!ndef_msg_rec_pack(&raw));
+
+    TEST_BYTES_SET(raw, data);
+    pack = ndef_msg_rec_pack(&raw);
+    g_assert(pack);
+    g_assert(!ndef_msg_rec_unpack(pack, NULL));
+    g_assert(ndef_msg_rec_unpack(pack, &rec));
+    g_assert(rec.raw.bytes != data);
+    g_assert_cmpuint(rec.raw.size, == ,sizeof(data) - 1);
+    g_assert(!memcmp(rec.raw.bytes, data, rec.raw.size));
+    g_assert_cmpuint(rec.hdr, == ,data[0]);
+    g_assert_cmpint(rec.tnf, == ,NDEF_TNF_WELL_KNOWN);
+    g_assert_cmpuint(rec.type.size, == ,1);
+    g_assert_cmpint(rec.type.bytes[0], == ,'x');
+    g_assert_cmpuint(rec.id.size, == ,2);
+    g_assert(!memcmp(rec.id.bytes, "id", 2));
+    g_assert_cmpuint(rec.payload.size, == ,1);
+    g_assert_cmpuint(rec.payload.bytes[0], == ,1);
+    g_free(pack);
+}
+
+/*==========================================================================*
+ * garbage
+ *==========================================================================*/
+
+typedef struct test_garbage_data {
+    const char* name;
+    GUtilData data;
+    gsize offset;
+} TestGarbage;
+
+static const guint8 garbage_short[] = {
+    0xd1, 0x01, 0x00, 'x',      /* Valid record */
+    0xd1, 0x01                  /* Too short */
+};
+static const guint8 garbage_long_hdr[] = {
+    0xc1, 0x01, 0x00            /* Long record with truncated header */
+};
+static const guint8 garbage_id_hdr[] = {
+    0xd9, 0x01, 0x00            /* ID length is missing */
+};
+static const guint8 garbage_length[] = {
+    0xd1, 0x01, 0x02, 'x', 0x00 /* Payload is truncated */
+};
+static const guint8 garbage_overflow[] = {
+    0xc1, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00
+};
+static const TestGarbage garbage_tests[] = {
+    { "short", { TEST_ARRAY_AND_SIZE(garbage_short) }, 4 },
+    { "long_hdr", { TEST_ARRAY_AND_SIZE(garbage_long_hdr) }, 0 },
+    { "id_hdr", { TEST_ARRAY_AND_SIZE(garbage_id_hdr) }, 0 },
+    { "length", { TEST_ARRAY_AND_SIZE(garbage_length) }, 0 },
+    { "overflow", { TEST_ARRAY_AND_SIZE(garbage_overflow) }, 0 }
+};
+
+static
+void
+test_garbage(
+    gconstpointer test_data)
+{
+    const TestGarbage* test = test_data;
+    NdefMsgIter it;
+    NdefMsgRec rec;
+
+    ndef_msg_iter_init(&it, &test->data);
+    while (ndef_msg_iter_next(&it, &rec));
+    g_assert_cmpuint(it.offset, == ,test->offset);
+    g_assert_cmpuint(it.data.size, == ,test->data.size - test->offset);
+    g_assert(it.data.bytes == test->data.bytes + test->offset);
+}
+
+/*==========================================================================*
+ * check
+ *==========================================================================*/
+
+typedef struct test_check_data {
+    const char* name;
+    GUtilData data;
+    gsize size;
+    gsize error_offset;
+} TestCheck;
+
+static const guint8 check_ok_empty[] = {
+    0xd0, 0x00, 0x00
+};
+static const guint8 check_ok_trailing[] = {
+    0xd1, 0x01, 0x00, 'x',
+    0x00                        /* Not a part of the message */
+};
+static const guint8 check_ok_chunked[] = {
+    0xb1, 0x01, 0x01, 'x', 'a', /* MB,CF,SR,TNF=0x01 */
+    0x36, 0x00, 0x01, 'b',      /* CF,SR,TNF=0x06 */
+    0x56, 0x00, 0x01, 'c'       /* ME,SR,TNF=0x06 */
+};
+static const guint8 check_ok_unknown[] = {
+    0xd5, 0x00, 0x01, 'a'
+};
+static const guint8 check_no_mb[] = {
+    0x51, 0x01, 0x00, 'x'
+};
+static const guint8 check_extra_mb[] = {
+    0x91, 0x01, 0x00, 'x',
+    0xd1, 0x01, 0x00, 'y'
+};
+static const guint8 check_no_me[] = {
+    0x91, 0x01, 0x00, 'x'
+};
+static const guint8 check_garbage[] = {
+    0x91, 0x01, 0x00, 'x',
+    0x51, 0x01, 0x05, 'y'
+};
+static const guint8 check_empty_payload[] = {
+    0xd0, 0x00, 0x01, 'x'
+};
+static const guint8 check_no_type[] = {
+    0xd1, 0x00, 0x00
+};
+static const guint8 check_unknown_type[] = {
+    0xd5, 0x01, 0x00, 'x'
+};
+static const guint8 check_unchanged[] = {
+    0xd6, 0x00, 0x00
+};
+static const guint8 check_reserved[] = {
+    0xd7, 0x00, 0x00
+};
+static const guint8 check_chunk_me[] = {
+    0xf1, 0x01, 0x00, 'x'
+};
+static const guint8 check_chunk_type[] = {
+    0xb1, 0x01, 0x01, 'x', 'a',
+    0x51, 0x01, 0x01, 'x', 'b'
+};
+static const guint8 check_chunk_il[] = {
+    0xb1, 0x01, 0x01, 'x', 'a',
+    0x5e, 0x00, 0x01, 0x00, 'b'
+};
+static const TestCheck check_tests[] = {
+    { "ok/empty", { TEST_ARRAY_AND_SIZE(check_ok_empty) }, 3, 0 },
+    { "ok/trailing", { TEST_ARRAY_AND_SIZE(check_ok_trailing) }, 4, 0 },
+    { "ok/chunked", { TEST_ARRAY_AND_SIZE(check_ok_chunked) }, 13, 0 },
+    { "ok/unknown", { TEST_ARRAY_AND_SIZE(check_ok_unknown) }, 4, 0 },
+    { "empty", { NULL, 0 }, 0, 0 },
+    { "no_mb", { TEST_ARRAY_AND_SIZE(check_no_mb) }, 0, 0 },
+    { "extra_mb", { TEST_ARRAY_AND_SIZE(check_extra_mb) }, 0, 4 },
+    { "no_me", { TEST_ARRAY_AND_SIZE(check_no_me) }, 0, 4 },
+    { "garbage", { TEST_ARRAY_AND_SIZE(check_garbage) }, 0, 4 },
+    { "empty_payload", { TEST_ARRAY_AND_SIZE(check_empty_payload) }, 0, 0 },
+    { "no_type", { TEST_ARRAY_AND_SIZE(check_no_type) }, 0, 0 },
+    { "unknown_type", { TEST_ARRAY_AND_SIZE(check_unknown_type) }, 0, 0 },
+    { "unchanged", { TEST_ARRAY_AND_SIZE(check_unchanged) }, 0, 0 },
+    { "reserved", { TEST_ARRAY_AND_SIZE(check_reserved) }, 0, 0 },
+    { "chunk_me", { TEST_ARRAY_AND_SIZE(check_chunk_me) }, 0, 0 },
+    { "chunk_type", { TEST_ARRAY_AND_SIZE(check_chunk_type) }, 0, 5 },
+    { "chunk_il", { TEST_ARRAY_AND_SIZE(check_chunk_il) }, 0, 5 }
+};
+
+static
+void
+test_check_null(
+    void)
+{
+    gsize offset = 1;
+
+    g_assert_cmpuint(ndef_msg_check(NULL, NULL), == ,0);
+    g_assert_cmpuint(ndef_msg_check(NULL, &offset), == ,0);
+    g_assert_cmpuint(offset, == ,0);
+}
+
+static
+void
+test_check(
+    gconstpointer test_data)
+{
+    const TestCheck* test = test_data;
+    gsize offset = (gsize)-1;
+
+    g_assert_cmpuint(ndef_msg_check(&test->data, NULL), == ,test->size);
+    g_assert_cmpuint(ndef_msg_check(&test->data, &offset), == ,test->size);
+    if (test->size) {
+        /* Untouched */
+        g_assert_cmpuint(offset, == ,(gsize)-1);
+    } else {
+        g_assert_cmpuint(offset, == ,test->error_offset);
+    }
+}
+
+/*==========================================================================*
+ * visit
+ *==========================================================================*/
+
+static
+gboolean
+test_visit_uri(
+    const NdefMsgRec* rec,
+    const GUtilData* prefix,
+    const GUtilData* suffix,
+    gpointer user_data)
+{
+    char* uri = ndef_msg_decode_uri(prefix, suffix);
+
+    g_string_append_printf(user_data, "U(%s)", uri);
+    g_free(uri);
+    return TRUE;
+}
+
+static
+gboolean
+test_visit_text(
+    const NdefMsgRec* rec,
+    const GUtilData* lang,
+    const GUtilData* text,
+    NDEF_REC_T_ENC enc,
+    gpointer user_data)
+{
+    char* str = ndef_msg_decode_text(text, enc);
+
+    g_string_append_printf(user_data, "T(%.*s:%s)", (int) lang->size,
+        lang->bytes, str);
+    g_free(str);
+    return TRUE;
+}
+
+static
+gboolean
+test_visit_sp_start(
+    const NdefMsgRec* rec,
+    gpointer user_data)
+{
+    g_string_append(user_data, "SP[");
+    return TRUE;
+}
+
+static
+gboolean
+test_visit_sp_act(
+    const NdefMsgRec* rec,
+    NDEF_SP_ACT act,
+    gpointer user_data)
+{
+    g_string_append_printf(user_data, "A(%d)", act);
+    return TRUE;
+}
+
+static
+gboolean
+test_visit_sp_size(
+    const NdefMsgRec* rec,
+    guint size,
+    gpointer user_data)
+{
+    g_string_append_printf(user_data, "S(%u)", size);
+    return TRUE;
+}
+
+static
+gboolean
+test_visit_sp_type(
+    const NdefMsgRec* rec,
+    const GUtilData* type,
+    gpointer user_data)
+{
+    g_string_append_printf(user_data, "Y(%.*s)", (int) type->size,
+        type->bytes);
+    return TRUE;
+}
+
+static
+gboolean
+test_visit_sp_icon(
+    const NdefMsgRec* rec,
+    const GUtilData* type,
+    const GUtilData* data,
+    gpointer user_data)
+{
+    g_string_append_printf(user_data, "I(%.*s:%u)", (int) type->size,
+        type->bytes, (guint) data->size);
+    return TRUE;
+}
+
+static
+gboolean
+test_visit_sp_end(
+    const NdefMsgRec* rec,
+    gpointer user_data)
+{
+    g_string_append(user_data, "]");
+    return TRUE;
+}
+
+static
+gboolean
+test_visit_other(
+    const NdefMsgRec* rec,
+    gpointer user_data)
+{
+    g_string_append_printf(user_data, "O(%.*s)", (int) rec->type.size,
+        rec->type.bytes);
+    return TRUE;
+}
+
+static
+gboolean
+test_visit_stop(
+    const NdefMsgRec* rec,
+    gpointer user_data)
+{
+    g_string_append(user_data, "STOP");
+    return FALSE;
+}
+
+static
+void
+test_visit(
+    void)
+{
+    static const guint8 data[] = {
+        0x91, 0x01, 0x05, 'U',  /* MB,SR,TNF=0x01 */
+        0x03, 'a', '.', 'b', 'c',
+        0x11, 0x01, 0x05, 'T',  /* SR,TNF=0x01 */
+        0x02, 'e', 'n', 'h', 'i',
+        0x51, 0x02, 0x34,       /* ME,SR,TNF=0x01 */
+        'S', 'p',
+            0x91, 0x01, 0x02, 'U', 0x00, 'x',
+            0x11, 0x03, 0x01, 'a', 'c', 't', 0x01,
+            0x11, 0x01, 0x04, 's', 0x00, 0x00, 0x01, 0x00,
+            0x11, 0x01, 0x0a, 't',
+            't', 'e', 'x', 't', '/', 'p', 'l', 'a', 'i', 'n',
+            0x12, 0x09, 0x01,   /* SR,TNF=0x02 */
+            'i', 'm', 'a', 'g', 'e', '/', 'p', 'n', 'g', 0x00,
+            0x51, 0x01, 0x00, 'z'
+    };
+    static const NdefMsgVisitor visitor = {
+        test_visit_uri,
+        test_visit_text,
+        test_visit_sp_start,
+        test_visit_sp_act,
+        test_visit_sp_size,
+        test_visit_sp_type,
+        test_visit_sp_icon,
+        test_visit_sp_end,
+        test_visit_other
+    };
+    NdefMsgVisitor v;
+    GString* buf = g_string_new(NULL);
+    GUtilData msg;
+
+    /* NULL tolerance */
+    g_assert(!ndef_msg_visit(NULL, &visitor, buf));
+    g_assert(!ndef_msg_visit(&msg, NULL, buf));
+
+    TEST_BYTES_SET(msg, data);
+    g_assert(ndef_msg_visit(&msg, &visitor, buf));
+    g_assert_cmpstr(buf->str, == ,"U(http://a.bc)T(en:hi)SP[U(x)A(1)"
+        "S(256)Y(text/plain)I(image/png:1)O(z)]");
+
+    /* Callbacks are optional */
+    memset(&v, 0, sizeof(v));
+    g_assert(ndef_msg_visit(&msg, &v, NULL));
+
+    /* Stop at Smart Poster */
+    g_string_set_size(buf, 0);
+    v = visitor;
+    v.sp_start = test_visit_stop;
+    g_assert(!ndef_msg_visit(&msg, &v, buf));
+    g_assert_cmpstr(buf->str, == ,"U(http://a.bc)T(en:hi)STOP");
+
+    /* Garbage at the end */
+    g_string_set_size(buf, 0);
+    msg.size = 16;
+    g_assert(!ndef_msg_visit(&msg, &visitor, buf));
+    g_assert_cmpstr(buf->str, == ,"U(http://a.bc)");
+    g_string_free(buf, TRUE);
+}
+
+/*==========================================================================*
+ * decode
+ *==========================================================================*/
+
+static
+void
+test_decode(
+    void)
+{
+    static const guint8 utf16le[] = { 'h', 0x00, 'i', 0x00 };
+    static const guint8 utf16be[] = { 0x00, 'h', 0x00, 'i' };
+    static const guint8 bad_utf8[] = { 0xff };
+    static const guint8 bad_utf16[] = { 0x00 };
+    GUtilData data;
+    char* str;
+
+    str = ndef_msg_decode_uri(NULL, NULL);
+    g_assert_cmpstr(str, == ,"");
+    g_free(str);
+
+    g_assert(!ndef_msg_decode_text(NULL, NDEF_REC_T_ENC_UTF8));
+
+    memset(&data, 0, sizeof(data));
+    str = ndef_msg_decode_text(&data, NDEF_REC_T_ENC_UTF16BE);
+    g_assert_cmpstr(str, == ,"");
+    g_free(str);
+
+    TEST_BYTES_SET(data, utf16le);
+    str = ndef_msg_decode_text(&data, NDEF_REC_T_ENC_UTF16LE);
+    g_assert_cmpstr(str, == ,"hi");
+    g_free(str);
+
+    TEST_BYTES_SET(data, utf16be);
+    str = ndef_msg_decode_text(&data, NDEF_REC_T_ENC_UTF16BE);
+    g_assert_cmpstr(str, == ,"hi");
+    g_free(str);
+
+    TEST_BYTES_SET(data, bad_utf8);
+    g_assert(!ndef_msg_decode_text(&data, NDEF_REC_T_ENC_UTF8));
+    TEST_BYTES_SET(data, bad_utf16);
+    g_assert(!ndef_msg_decode_text(&data, NDEF_REC_T_ENC_UTF16BE));
+}
+
+/*==========================================================================*
+ * Common
+ *==========================================================================*/
+
+#define TEST_(name) "/ndef_msg/" name
+
+int main(int argc, char* argv[])
+{
+    guint i;
+
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("null"), test_null);
+    g_test_add_func(TEST_("records"), test_records);
+    g_test_add_func(TEST_("index"), test_index);
+    g_test_add_func(TEST_("pack"), test_pack);
+    g_test_add_func(TEST_("check/null"), test_check_null);
+    for (i = 0; i < G_N_ELEMENTS(check_tests); i++) {
+        const TestCheck* test = check_tests + i;
+        char* path = g_strconcat(TEST_("check/"), test->name, NULL);
+
+        g_test_add_data_func(path, test, test_check);
+        g_free(path);
+    }
+    g_test_add_func(TEST_("visit"), test_visit);
+    g_test_add_func(TEST_("decode"), test_decode);
+    for (i = 0; i < G_N_ELEMENTS(garbage_tests); i++) {
+        const TestGarbage* test = garbage_tests + i;
+        char* path = g_strconcat(TEST_("garbage/"), test->name, NULL);
+
+        g_test_add_data_func(path, test, test_garbage);
+        g_free(path);
+    }
+    test_init(&test_opt, argc, argv);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,287 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "test_common.h"
+
+#include "ndef_rec.h"
+
+static TestOpt test_opt;
+static const char* test_system_locale = NULL;
+
+/* "Hi" in UTF-16BE without BOM */
+static const guint8 test_text_be[] = {
+    0xd1, 0x01, 0x07, 'T',
+    0x82, 'e', 'n', 0x00, 'H', 0x00, 'i'
+};
+
+/* "Hi" in UTF-16LE with BOM */
+static const guint8 test_text_le[] = {
+    0xd1, 0x01, 0x09, 'T',
+    0x82, 'e', 'n', 0xff, 0xfe, 'H', 0x00, 'i', 0x00
+};
+
+/* Odd number of bytes */
+static const guint8 test_text_bad[] = {
+    0xd1, 0x01, 0x06, 'T',
+    0x82, 'e', 'n', 0x00, 'H', 0x00
+};
+
+/* URI, English title, broken Finnish title */
+static const guint8 test_sp_bad_title[] = {
+    0xd1, 0x02, 0x1d, 'S', 'p',
+    0x91, 0x01, 0x04, 'U', 0x01, 'a', '.', 'b',
+    0x11, 0x01, 0x07, 'T', 0x82, 'e', 'n', 0x00, 'H', 0x00, 'i',
+    0x51, 0x01, 0x06, 'T', 0x82, 'f', 'i', 0x00, 'M', 0x00
+};
+
+/* Same as above plus a good Finnish title */
+static const guint8 test_sp_good_title[] = {
+    0xd1, 0x02, 0x2a, 'S', 'p',
+    0x91, 0x01, 0x04, 'U', 0x01, 'a', '.', 'b',
+    0x11, 0x01, 0x07, 'T', 0x82, 'e', 'n', 0x00, 'H', 0x00, 'i',
+    0x11, 0x01, 0x06, 'T', 0x82, 'f', 'i', 0x00, 'M', 0x00,
+    0x51, 0x01, 0x09, 'T', 0x82, 'f', 'i', 0x00, 'M', 0x00, 'o', 0x00, 'i'
+};
+
+/* Stubs */
+
+const char*
+ndef_system_locale(
+    void)
+{
+    return test_system_locale;
+}
+
+/* Utilities */
+
+static
+void
+test_check_text(
+    NdefRec* rec)
+{
+    NdefRecT* t;
+
+    g_assert(NDEF_IS_REC_T(rec));
+    t = NDEF_REC_T(rec);
+    g_assert_cmpstr(t->text, == ,"Hi");
+    g_assert_cmpstr(t->lang, == ,"en");
+    ndef_rec_unref(rec);
+}
+
+static
+void
+test_check_sp(
+    NdefRec* rec,
+    const char* title,
+    const char* lang)
+{
+    NdefRecSp* sp;
+
+    g_assert(NDEF_IS_REC_SP(rec));
+    sp = NDEF_REC_SP(rec);
+    g_assert_cmpstr(sp->uri, == ,"http://www.a.b");
+    g_assert_cmpstr(sp->title, == ,title);
+    g_assert_cmpstr(sp->lang, == ,lang);
+    ndef_rec_unref(rec);
+}
+
+/*==========================================================================*
+ * null
+ *==========================================================================*/
+
+static
+void
+test_null(
+    void)
+{
+    NdefParser* parser = ndef_parser_new(NULL);
+    NDEF_PARSE_RESULT result = NDEF_PARSE_OK;
+    GUtilData data;
+
+    ndef_parser_free(NULL);
+    g_assert(!ndef_parser_parse(parser, NULL, &result));
+    g_assert_cmpint(result, == ,NDEF_PARSE_ERROR);
+    result = NDEF_PARSE_OK;
+    g_assert(!ndef_parser_parse_tlv(parser, NULL, &result));
+    g_assert_cmpint(result, == ,NDEF_PARSE_ERROR);
+    ndef_parser_free(parser);
+
+    /* NULL parser is the same as no options */
+    TEST_BYTES_SET(data, test_text_be);
+    test_check_text(ndef_parser_parse(NULL, &data, NULL));
+    g_assert(!ndef_parser_parse_tlv(NULL, &data, NULL));
+}
+
+/*==========================================================================*
+ * text
+ *==========================================================================*/
+
+static
+void
+test_text(
+    void)
+{
+    NdefParser* parser = ndef_parser_new(NULL);
+    NDEF_PARSE_RESULT result;
+    GUtilData be, le, bad;
+    NdefRec* rec;
+    guint i;
+
+    TEST_BYTES_SET(be, test_text_be);
+    TEST_BYTES_SET(le, test_text_le);
+    TEST_BYTES_SET(bad, test_text_bad);
+
+    /* The converters are reused, including after a failure */
+    for (i = 0; i < 3; i++) {
+        test_check_text(ndef_parser_parse(parser, &be, &result));
+        g_assert_cmpint(result, == ,NDEF_PARSE_OK);
+        test_check_text(ndef_parser_parse(parser, &le, &result));
+        g_assert_cmpint(result, == ,NDEF_PARSE_OK);
+
+        /* Broken text turns into a generic record */
+        rec = ndef_parser_parse(parser, &bad, &result);
+        g_assert(rec);
+        g_assert(!NDEF_IS_REC_T(rec));
+        g_assert_cmpint(rec->rtd, == ,NDEF_RTD_UNKNOWN);
+        g_assert_cmpint(result, == ,NDEF_PARSE_OK);
+        ndef_rec_unref(rec);
+    }
+    ndef_parser_free(parser);
+}
+
+/*==========================================================================*
+ * sp
+ *==========================================================================*/
+
+static
+void
+test_sp(
+    void)
+{
+    NdefParser* parser = ndef_parser_new(NULL);
+    GUtilData data;
+
+    test_system_locale = "fi_FI";
+
+    /* Failed conversion of a better title keeps the previous one */
+    TEST_BYTES_SET(data, test_sp_bad_title);
+    test_check_sp(ndef_parser_parse(parser, &data, NULL), "Hi", "en");
+    test_check_sp(ndef_rec_new(&data), "Hi", "en");
+
+    TEST_BYTES_SET(data, test_sp_good_title);
+    test_check_sp(ndef_parser_parse(parser, &data, NULL), "Moi", "fi");
+    test_check_sp(ndef_rec_new(&data), "Moi", "fi");
+
+    test_system_locale = NULL;
+    ndef_parser_free(parser);
+}
+
+/*==========================================================================*
+ * opt
+ *==========================================================================*/
+
+static
+void
+test_opt_limits(
+    void)
+{
+    static const guint8 two_recs[] = {
+        0x91, 0x01, 0x02, 'U', 0x01, 'x',
+        0x51, 0x01, 0x02, 'U', 0x01, 'y'
+    };
+    static const guint8 two_recs_tlv[] = {
+        0x03, 0x0c,
+        0x91, 0x01, 0x02, 'U', 0x01, 'x',
+        0x51, 0x01, 0x02, 'U', 0x01, 'y',
+        0xfe
+    };
+    NDEF_PARSE_RESULT result;
+    NdefParser* parser;
+    NdefParseOpt opt;
+    GUtilData data;
+    NdefRec* rec;
+
+    memset(&opt, 0, sizeof(opt));
+    opt.max_records = 1;
+    parser = ndef_parser_new(&opt);
+
+    /* The options are copied and apply to each call */
+    opt.max_records = 0;
+    TEST_BYTES_SET(data, two_recs);
+    g_assert(!ndef_parser_parse(parser, &data, &result));
+    g_assert_cmpint(result, == ,NDEF_PARSE_LIMIT_RECORDS);
+
+    data.size = 6;
+    rec = ndef_parser_parse(parser, &data, &result);
+    g_assert(NDEF_IS_REC_U(rec));
+    g_assert_cmpint(result, == ,NDEF_PARSE_OK);
+    ndef_rec_unref(rec);
+
+    TEST_BYTES_SET(data, two_recs_tlv);
+    g_assert(!ndef_parser_parse_tlv(parser, &data, &result));
+    g_assert_cmpint(result, == ,NDEF_PARSE_LIMIT_RECORDS);
+    ndef_parser_free(parser);
+}
+
+/*==========================================================================*
+ * Common
+ *==========================================================================*/
+
+#define TEST_(name) "/ndef_parser/" name
+
+int main(int argc, char* argv[])
+{
+    G_GNUC_BEGIN_IGNORE_DEPRECATIONS;
+    g_type_init();
+    G_GNUC_END_IGNORE_DEPRECATIONS;
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("null"), test_null);
+    g_test_add_func(TEST_("text"), test_text);
+    g_test_add_func(TEST_("sp"), test_sp);
+    g_test_add_func(TEST_("opt"), test_opt_limits);
+    test_init(&test_opt, argc, argv);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,633 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "test_common.h"
+
+#include "ndef_rec.h"
+#include "ndef_tlv.h"
+
+#include <gutil_log.h>
+
+#ifdef __GLIBC__
+#  include <malloc.h>
+#endif
+
+static TestOpt test_opt;
+
+/*
+ * Each input is generated in two sizes, TEST_SCALE times apart. Time
+ * spent on the larger one must not exceed what linear behaviour would
+ * give, with a generous TEST_SLACK for the noise. Quadratic behaviour
+ * blows it by a factor of TEST_SCALE/TEST_SLACK. Very short times are
+ * rounded up to TEST_MIN_TIME_US for the same reason. Perf mode (-m perf)
+ * doesn't allow any extra slack, otherwise it's doubled to survive
+ * a loaded build machine.
+ */
+#define TEST_SCALE (8)
+#define TEST_SLACK (3)
+#define TEST_RUNS (3)
+#define TEST_MIN_TIME_US (2000)
+
+/* Smallest NDEF record is 3 bytes long */
+#define TEST_MIN_REC_SIZE (3)
+
+/*
+ * The heap growth caused by parsing (measured by malloc itself, where
+ * possible) must be linear in the size of the input: a few times the
+ * input for the copies and decoded strings, plus an object for each
+ * record which could possibly fit into the input, plus a constant for
+ * whatever GLib allocates in chunks.
+ */
+#define TEST_MEM_PER_BYTE (4)
+#define TEST_MEM_PER_REC (512)
+#define TEST_MEM_MIN (0x10000)
+
+/* Largest heap growth caused by a single parse */
+static gsize test_heap_peak;
+
+static const char* test_system_locale = "en_US.UTF-8";
+
+/* Stubs */
+
+const char*
+ndef_system_locale(
+    void)
+{
+    return test_system_locale;
+}
+
+/* Utilities */
+
+static
+gsize
+test_heap_used(
+    void)
+{
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2,33)
+    const struct mallinfo2 mi = mallinfo2();
+#else
+    const struct mallinfo mi = mallinfo();
+#endif
+
+    /* Small chunks plus mmapped ones */
+    return (gsize) mi.uordblks + (gsize) mi.hblkhd;
+#else
+    /* No way to tell */
+    return 0;
+#endif
+}
+
+static
+void
+test_heap_update(
+    gsize before)
+{
+    const gsize after = test_heap_used();
+
+    if (after > before && (after - before) > test_heap_peak) {
+        test_heap_peak = after - before;
+    }
+}
+
+typedef struct test_perf {
+    const char* name;
+    GByteArray* (*build)(guint n);
+    void (*run)(const GUtilData* data, guint n);
+    guint n;
+} TestPerf;
+
+static
+void
+test_append_hdr(
+    GByteArray* buf,
+    guint8 hdr,
+    const char* type,
+    gsize payload_len)
+{
+    const guint8 type_len = (guint8) strlen(type);
+
+    /* Always using the long format, it doesn't really matter */
+    g_byte_array_append(buf, &hdr, 1);
+    g_byte_array_append(buf, &type_len, 1);
+    hdr = (guint8)(payload_len >> 24); g_byte_array_append(buf, &hdr, 1);
+    hdr = (guint8)(payload_len >> 16); g_byte_array_append(buf, &hdr, 1);
+    hdr = (guint8)(payload_len >> 8); g_byte_array_append(buf, &hdr, 1);
+    hdr = (guint8)payload_len; g_byte_array_append(buf, &hdr, 1);
+    g_byte_array_append(buf, (const guint8*) type, type_len);
+}
+
+static
+void
+test_append_rec(
+    GByteArray* buf,
+    guint8 hdr,
+    const char* type,
+    const void* payload,
+    gsize payload_len)
+{
+    test_append_hdr(buf, hdr, type, payload_len);
+    g_byte_array_append(buf, payload, payload_len);
+}
+
+static
+NdefRec*
+test_parse(
+    const GUtilData* data)
+{
+    const gsize heap = test_heap_used();
+    NDEF_PARSE_RESULT result;
+    NdefRec* rec = ndef_rec_new_opt(data, NULL, &result);
+
+    test_heap_update(heap);
+    g_assert_cmpint(result, == ,NDEF_PARSE_OK);
+    g_assert(rec);
+    return rec;
+}
+
+static
+void
+test_check_heap(
+    const char* name,
+    gsize size,
+    gsize used)
+{
+    const gsize max = TEST_MEM_MIN + size * TEST_MEM_PER_BYTE +
+        (size / TEST_MIN_REC_SIZE + 1) * TEST_MEM_PER_REC;
+
+    GDEBUG("%s: %u bytes => %u bytes of heap", name, (guint) size,
+        (guint) used);
+    g_assert_cmpuint(used, <= ,max);
+}
+
+static
+gint64
+test_run(
+    const TestPerf* test,
+    guint n)
+{
+    GByteArray* buf = test->build(n);
+    GUtilData data;
+    gint64 best = 0;
+    gsize heap = 0;
+    int i;
+
+    data.bytes = buf->data;
+    data.size = buf->len;
+    for (i = 0; i < TEST_RUNS; i++) {
+        const gint64 start = g_get_monotonic_time();
+        gint64 t;
+
+        /* The first run may also be initializing something */
+        test_heap_peak = 0;
+        test->run(&data, n);
+        t = g_get_monotonic_time() - start;
+        if (!i || t < best) {
+            best = t;
+        }
+        if (!i || test_heap_peak < heap) {
+            heap = test_heap_peak;
+        }
+    }
+    test_check_heap(test->name, data.size, heap);
+    g_byte_array_free(buf, TRUE);
+    return best;
+}
+
+static
+void
+test_perf(
+    gconstpointer param)
+{
+    const TestPerf* test = param;
+    const gint64 t1 = test_run(test, test->n);
+    const gint64 t2 = test_run(test, test->n * TEST_SCALE);
+
+    GDEBUG("%s: %u => %d us, %u => %d us (%d ns each)", test->name,
+        test->n, (int) t1, test->n * TEST_SCALE, (int) t2,
+        (int) (t2 * 1000 / (test->n * TEST_SCALE)));
+    g_assert_cmpint(t2, <= ,MAX(t1, TEST_MIN_TIME_US) *
+        TEST_SCALE * TEST_SLACK * (g_test_perf() ? 1 : 2));
+}
+
+/*==========================================================================*
+ * tlv_null
+ *==========================================================================*/
+
+static
+GByteArray*
+test_tlv_null_build(
+    guint n)
+{
+    static const guint8 tail[] = {
+        TLV_NDEF_MESSAGE, 0x03,
+        0xd0, 0x00, 0x00,       /* Empty NDEF */
+        TLV_TERMINATOR
+    };
+    GByteArray* buf = g_byte_array_sized_new(n + sizeof(tail));
+
+    g_byte_array_set_size(buf, n);
+    memset(buf->data, TLV_NULL, n);
+    g_byte_array_append(buf, TEST_ARRAY_AND_SIZE(tail));
+    return buf;
+}
+
+static
+void
+test_tlv_null_run(
+    const GUtilData* data,
+    guint n)
+{
+    GUtilData buf = *data;
+    GUtilData value;
+    NdefRec* rec;
+    gsize heap;
+
+    g_assert_cmpuint(ndef_tlv_check(data), == ,data->size);
+    g_assert_cmpuint(ndef_tlv_next(&buf, &value), == ,TLV_NDEF_MESSAGE);
+    g_assert_cmpuint(ndef_tlv_next(&buf, &value), == ,0);
+    g_assert_cmpuint(buf.size, == ,0);
+
+    heap = test_heap_used();
+    rec = ndef_rec_new_from_tlv(data);
+    test_heap_update(heap);
+    g_assert(rec);
+    g_assert(!rec->next);
+    ndef_rec_unref(rec);
+}
+
+/*==========================================================================*
+ * empty_chain
+ *==========================================================================*/
+
+static
+GByteArray*
+test_empty_chain_build(
+    guint n)
+{
+    GByteArray* buf = g_byte_array_sized_new(n * TEST_MIN_REC_SIZE);
+    guint i;
+
+    for (i = 0; i < n; i++) {
+        /* SR, TNF=0 (Empty) */
+        guint8 rec[TEST_MIN_REC_SIZE] = { 0x10, 0x00, 0x00 };
+
+        if (!i) {
+            rec[0] |= 0x80; /* MB */
+        }
+        if (i == (n - 1)) {
+            rec[0] |= 0x40; /* ME */
+        }
+        g_byte_array_append(buf, TEST_ARRAY_AND_SIZE(rec));
+    }
+    return buf;
+}
+
+static
+void
+test_empty_chain_run(
+    const GUtilData* data,
+    guint n)
+{
+    NdefRec* rec = test_parse(data);
+    NdefRec* last = rec;
+    guint count = 1;
+
+    while (last->next) {
+        last = last->next;
+        count++;
+    }
+    g_assert_cmpuint(count, == ,n);
+
+    /* This used to blow the stack */
+    ndef_rec_unref(rec);
+}
+
+/*==========================================================================*
+ * sp_titles
+ *==========================================================================*/
+
+static
+void
+test_append_sp_content(
+    GByteArray* buf,
+    guint8 mb)
+{
+    static const guint8 uri[] = { 0x00, 'x' };
+
+    test_append_rec(buf, mb | 0x01, "U", TEST_ARRAY_AND_SIZE(uri));
+}
+
+static
+GByteArray*
+test_sp_titles_build(
+    guint n)
+{
+    static const guint8 fr_title[] = { 0x02, 'f', 'r', 'x' };
+    static const guint8 en_title[] = { 0x02, 'e', 'n', 'y' };
+    GByteArray* content = g_byte_array_new();
+    GByteArray* buf = g_byte_array_new();
+    guint i;
+
+    /* Only the last title matches the system language */
+    test_append_sp_content(content, 0x80);
+    for (i = 1; i < n; i++) {
+        test_append_rec(content, 0x01, "T", TEST_ARRAY_AND_SIZE(fr_title));
+    }
+    test_append_rec(content, 0x41, "T", TEST_ARRAY_AND_SIZE(en_title));
+
+    test_append_rec(buf, 0xc1, "Sp", content->data, content->len);
+    g_byte_array_free(content, TRUE);
+    return buf;
+}
+
+static
+void
+test_sp_titles_run(
+    const GUtilData* data,
+    guint n)
+{
+    NdefRec* rec = test_parse(data);
+    NdefRecSp* sp;
+
+    g_assert(NDEF_IS_REC_SP(rec));
+    sp = NDEF_REC_SP(rec);
+    g_assert_cmpstr(sp->uri, == ,"x");
+    g_assert_cmpstr(sp->title, == ,"y");
+    g_assert_cmpstr(sp->lang, == ,"en");
+    ndef_rec_unref(rec);
+}
+
+/*==========================================================================*
+ * sp_nested
+ *==========================================================================*/
+
+static
+GByteArray*
+test_sp_nested_build(
+    guint n)
+{
+    GByteArray* buf = g_byte_array_new();
+    guint i;
+
+    /* Each poster contains a URI and the next poster */
+    test_append_sp_content(buf, 0xc0);
+    for (i = 0; i < n; i++) {
+        GByteArray* content = g_byte_array_new();
+
+        test_append_sp_content(content, 0x80);
+        test_append_rec(content, 0x41, "Sp", buf->data, buf->len);
+        g_byte_array_set_size(buf, 0);
+        test_append_rec(buf, 0xc1, "Sp", content->data, content->len);
+        g_byte_array_free(content, TRUE);
+    }
+    return buf;
+}
+
+static
+void
+test_sp_nested_run(
+    const GUtilData* data,
+    guint n)
+{
+    NdefRec* rec = test_parse(data);
+
+    g_assert(NDEF_IS_REC_SP(rec));
+    g_assert_cmpstr(NDEF_REC_SP(rec)->uri, == ,"x");
+    g_assert(!rec->next);
+    ndef_rec_unref(rec);
+}
+
+/*==========================================================================*
+ * utf16_text
+ *==========================================================================*/
+
+static
+GByteArray*
+test_utf16_text_build(
+    guint n)
+{
+    static const guint8 prefix[] = {
+        0x82, 'e', 'n',         /* UTF-16, language "en" */
+        0xfe, 0xff              /* BOM (BE) */
+    };
+    static const guint8 c[] = { 0x00, 'a' };
+    GByteArray* buf = g_byte_array_new();
+    guint i;
+
+    test_append_hdr(buf, 0xc1, "T", sizeof(prefix) + n * sizeof(c));
+    g_byte_array_append(buf, TEST_ARRAY_AND_SIZE(prefix));
+    for (i = 0; i < n; i++) {
+        g_byte_array_append(buf, TEST_ARRAY_AND_SIZE(c));
+    }
+    return buf;
+}
+
+static
+void
+test_utf16_text_run(
+    const GUtilData* data,
+    guint n)
+{
+    NdefRec* rec = test_parse(data);
+
+    g_assert(NDEF_IS_REC_T(rec));
+    g_assert_cmpuint(strlen(NDEF_REC_T(rec)->text), == ,n);
+    ndef_rec_unref(rec);
+}
+
+/*==========================================================================*
+ * uri_records
+ *==========================================================================*/
+
+static
+guint8
+test_chain_hdr(
+    guint i,
+    guint n)
+{
+    return (i ? 0 : 0x80) | ((i == (n - 1)) ? 0x40 : 0) | 0x01;
+}
+
+static
+GByteArray*
+test_uri_records_build(
+    guint n)
+{
+    static const guint8 uri[] = { 0x01, 'x' }; /* http://www.x */
+    GByteArray* buf = g_byte_array_new();
+    guint i;
+
+    for (i = 0; i < n; i++) {
+        test_append_rec(buf, test_chain_hdr(i, n), "U",
+            TEST_ARRAY_AND_SIZE(uri));
+    }
+    return buf;
+}
+
+static
+void
+test_uri_records_run(
+    const GUtilData* data,
+    guint n)
+{
+    NdefRec* rec = test_parse(data);
+    NdefRec* r;
+    guint count = 0;
+
+    for (r = rec; r; r = r->next) {
+        g_assert(NDEF_IS_REC_U(r));
+        count++;
+    }
+    g_assert_cmpuint(count, == ,n);
+    ndef_rec_unref(rec);
+}
+
+/*==========================================================================*
+ * sp_records
+ *==========================================================================*/
+
+static
+GByteArray*
+test_sp_records_build(
+    guint n)
+{
+    static const guint8 title[] = { 0x02, 'e', 'n', 'y' };
+    GByteArray* content = g_byte_array_new();
+    GByteArray* buf = g_byte_array_new();
+    guint i;
+
+    test_append_sp_content(content, 0x80);
+    test_append_rec(content, 0x41, "T", TEST_ARRAY_AND_SIZE(title));
+    for (i = 0; i < n; i++) {
+        test_append_rec(buf, test_chain_hdr(i, n), "Sp", content->data,
+            content->len);
+    }
+    g_byte_array_free(content, TRUE);
+    return buf;
+}
+
+static
+void
+test_sp_records_run(
+    const GUtilData* data,
+    guint n)
+{
+    NdefRec* rec = test_parse(data);
+    NdefRec* r;
+    guint count = 0;
+
+    for (r = rec; r; r = r->next) {
+        g_assert(NDEF_IS_REC_SP(r));
+        count++;
+    }
+    g_assert_cmpuint(count, == ,n);
+    ndef_rec_unref(rec);
+}
+
+/*==========================================================================*
+ * Common
+ *==========================================================================*/
+
+static const TestPerf perf_tests[] = {
+    {
+        "tlv_null",
+        test_tlv_null_build,
+        test_tlv_null_run,
+        100000
+    },{
+        "empty_chain",
+        test_empty_chain_build,
+        test_empty_chain_run,
+        10000
+    },{
+        "sp_titles",
+        test_sp_titles_build,
+        test_sp_titles_run,
+        1000
+    },{
+        "sp_nested",
+        test_sp_nested_build,
+        test_sp_nested_run,
+        500
+    },{
+        "utf16_text",
+        test_utf16_text_build,
+        test_utf16_text_run,
+        100000
+    },{
+        "uri_records",
+        test_uri_records_build,
+        test_uri_records_run,
+        10000
+    },{
+        "sp_records",
+        test_sp_records_build,
+        test_sp_records_run,
+        10000
+    }
+};
+
+#define TEST_(name) "/ndef_perf/" name
+
+int main(int argc, char* argv[])
+{
+    guint i;
+
+    G_GNUC_BEGIN_IGNORE_DEPRECATIONS;
+    g_type_init();
+    G_GNUC_END_IGNORE_DEPRECATIONS;
+    g_test_init(&argc, &argv, NULL);
+    for (i = 0; i < G_N_ELEMENTS(perf_tests); i++) {
+        const TestPerf* test = perf_tests + i;
+        char* path = g_strconcat(TEST_(""), test->name, NULL);
+
+        g_test_add_data_func(path, test, test_perf);
+        g_free(path);
+    }
+    test_init(&test_opt, argc, argv);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,340 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "test_common.h"
+
+#include "ndef_pipeline.h"
+
+static TestOpt test_opt;
+
+static const guint8 test_garbage[] = { 0x00 };
+
+/* Stubs */
+
+const char*
+ndef_system_locale(
+    void)
+{
+    return NULL;
+}
+
+/* Utilities */
+
+#define TEST_COUNT (1000)
+
+typedef struct test_consumer {
+    guint count;
+    gulong delay_us;
+} TestConsumer;
+
+/* Every third input is broken, the rest are URI records */
+static
+void
+test_submit(
+    NdefPipeline* pipe,
+    guint i,
+    gboolean tlv)
+{
+    if (i % 3) {
+        char* suffix = g_strdup_printf("%u", i);
+        const gsize len = strlen(suffix);
+        guint8* data = g_malloc0(len + 8);
+        guint8* rec = tlv ? (data + 2) : data;
+        GUtilData input;
+
+        rec[0] = 0xd1; /* MB, ME, SR, TNF=0x01 */
+        rec[1] = 0x01;
+        rec[2] = (guint8) (len + 1);
+        rec[3] = 'U';
+        rec[4] = 0x01; /* http://www. */
+        memcpy(rec + 5, suffix, len);
+        if (tlv) {
+            data[0] = 0x03; /* NDEF Message TLV */
+            data[1] = (guint8) (len + 5);
+            data[len + 7] = 0xfe; /* Terminator TLV */
+        }
+        input.bytes = data;
+        input.size = len + (tlv ? 8 : 5);
+        g_assert_cmpuint(ndef_pipeline_submit(pipe, &input), == ,i);
+        g_free(data);
+        g_free(suffix);
+    } else {
+        GUtilData input;
+
+        TEST_BYTES_SET(input, test_garbage);
+        g_assert_cmpuint(ndef_pipeline_submit(pipe, &input), == ,i);
+    }
+}
+
+static
+void
+test_consume(
+    guint64 seq,
+    NdefRec* rec,
+    gpointer user_data)
+{
+    TestConsumer* consumer = user_data;
+
+    /* Results arrive in order */
+    g_assert_cmpuint(seq, == ,consumer->count);
+    if (seq % 3) {
+        char* uri = g_strdup_printf("http://www.%u", (guint) seq);
+
+        g_assert(NDEF_IS_REC_U(rec));
+        g_assert_cmpstr(NDEF_REC_U(rec)->uri, == ,uri);
+        g_free(uri);
+    } else {
+        g_assert(!rec);
+    }
+    consumer->count++;
+    if (consumer->delay_us) {
+        g_usleep(consumer->delay_us);
+    }
+}
+
+static
+void
+test_wait(
+    NdefPipeline* pipe,
+    guint count,
+    NdefPipelineStats* stats)
+{
+    ndef_pipeline_get_stats(pipe, stats);
+    while (stats->delivered < count) {
+        g_usleep(1000);
+        ndef_pipeline_get_stats(pipe, stats);
+    }
+}
+
+/*==========================================================================*
+ * null
+ *==========================================================================*/
+
+static
+void
+test_null(
+    void)
+{
+    NdefPipelineStats stats;
+    GUtilData input;
+
+    TEST_BYTES_SET(input, test_garbage);
+    memset(&stats, 0xff, sizeof(stats));
+    g_assert(!ndef_pipeline_new(1, 1, FALSE, NULL, NULL, NULL));
+    g_assert_cmpuint(ndef_pipeline_submit(NULL, &input), == ,0);
+    ndef_pipeline_get_stats(NULL, NULL);
+    ndef_pipeline_get_stats(NULL, &stats);
+    g_assert_cmpuint(stats.submitted, == ,0);
+    g_assert_cmpuint(stats.queued, == ,0);
+    ndef_pipeline_free(NULL);
+}
+
+/*==========================================================================*
+ * basic
+ *==========================================================================*/
+
+static
+void
+test_basic(
+    gconstpointer data)
+{
+    const guint threads = GPOINTER_TO_UINT(data);
+    TestConsumer consumer;
+    NdefPipelineStats stats;
+    NdefPipeline* pipe;
+    guint i;
+
+    memset(&consumer, 0, sizeof(consumer));
+    pipe = ndef_pipeline_new(threads, 0, FALSE, NULL, test_consume,
+        &consumer);
+    g_assert(pipe);
+    for (i = 0; i < TEST_COUNT; i++) {
+        test_submit(pipe, i, FALSE);
+    }
+
+    test_wait(pipe, TEST_COUNT, &stats);
+    g_assert_cmpuint(stats.submitted, == ,TEST_COUNT);
+    g_assert_cmpuint(stats.delivered, == ,TEST_COUNT);
+    g_assert_cmpuint(stats.failed, == ,(TEST_COUNT + 2) / 3);
+    g_assert_cmpuint(stats.queued, == ,0);
+    g_assert_cmpuint(stats.max_queued, > ,0);
+    g_assert_cmpint(stats.elapsed_us, > ,0);
+    ndef_pipeline_free(pipe);
+    g_assert_cmpuint(consumer.count, == ,TEST_COUNT);
+}
+
+/*==========================================================================*
+ * backpressure
+ *==========================================================================*/
+
+static
+void
+test_backpressure(
+    void)
+{
+    const guint count = 20;
+    TestConsumer consumer;
+    NdefPipelineStats stats;
+    NdefPipeline* pipe;
+    guint i;
+
+    /* The consumer is slow, the producer has to wait */
+    memset(&consumer, 0, sizeof(consumer));
+    consumer.delay_us = 2000;
+    pipe = ndef_pipeline_new(2, 2, FALSE, NULL, test_consume, &consumer);
+    for (i = 0; i < count; i++) {
+        test_submit(pipe, i, FALSE);
+        ndef_pipeline_get_stats(pipe, &stats);
+        g_assert_cmpuint(stats.queued, <= ,2);
+    }
+
+    test_wait(pipe, count, &stats);
+    g_assert_cmpuint(stats.delivered, == ,count);
+    g_assert_cmpuint(stats.blocked, > ,0);
+    g_assert_cmpuint(stats.max_queued, == ,2);
+    ndef_pipeline_free(pipe);
+    g_assert_cmpuint(consumer.count, == ,count);
+}
+
+/*==========================================================================*
+ * drain
+ *==========================================================================*/
+
+static
+void
+test_drain(
+    void)
+{
+    const guint count = 50;
+    TestConsumer consumer;
+    NdefPipeline* pipe;
+    guint i;
+
+    /* Free delivers whatever is still in the queue */
+    memset(&consumer, 0, sizeof(consumer));
+    consumer.delay_us = 100;
+    pipe = ndef_pipeline_new(4, count, TRUE, NULL, test_consume,
+        &consumer);
+    for (i = 0; i < count; i++) {
+        test_submit(pipe, i, TRUE);
+    }
+    ndef_pipeline_free(pipe);
+    g_assert_cmpuint(consumer.count, == ,count);
+}
+
+/*==========================================================================*
+ * opt
+ *==========================================================================*/
+
+static
+void
+test_opt_consume(
+    guint64 seq,
+    NdefRec* rec,
+    gpointer user_data)
+{
+    NdefRec** results = user_data;
+
+    results[seq] = ndef_rec_ref(rec);
+}
+
+static
+void
+test_opt_limits(
+    void)
+{
+    static const guint8 two_recs[] = {
+        0x91, 0x01, 0x02, 'U', 0x01, 'x',
+        0x51, 0x01, 0x02, 'U', 0x01, 'y'
+    };
+    NdefRec* results[2];
+    NdefPipeline* pipe;
+    NdefParseOpt opt;
+    GUtilData input;
+
+    memset(&opt, 0, sizeof(opt));
+    opt.max_records = 1;
+    TEST_BYTES_SET(input, two_recs);
+    pipe = ndef_pipeline_new(2, 1, FALSE, &opt, test_opt_consume, results);
+
+    /* The options are copied */
+    opt.max_records = 0;
+    g_assert_cmpuint(ndef_pipeline_submit(pipe, &input), == ,0);
+    input.size = 6;
+    g_assert_cmpuint(ndef_pipeline_submit(pipe, &input), == ,1);
+    ndef_pipeline_free(pipe);
+
+    g_assert(!results[0]);
+    g_assert(NDEF_IS_REC_U(results[1]));
+    g_assert_cmpstr(NDEF_REC_U(results[1])->uri, == ,"http://www.x");
+    ndef_rec_unref(results[1]);
+}
+
+/*==========================================================================*
+ * Common
+ *==========================================================================*/
+
+#define TEST_(name) "/ndef_pipeline/" name
+
+int main(int argc, char* argv[])
+{
+    G_GNUC_BEGIN_IGNORE_DEPRECATIONS;
+    g_type_init();
+    G_GNUC_END_IGNORE_DEPRECATIONS;
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("null"), test_null);
+    g_test_add_data_func(TEST_("default"), GUINT_TO_POINTER(0),
+        test_basic);
+    g_test_add_data_func(TEST_("single"), GUINT_TO_POINTER(1),
+        test_basic);
+    g_test_add_data_func(TEST_("many"), GUINT_TO_POINTER(8),
+        test_basic);
+    g_test_add_func(TEST_("backpressure"), test_backpressure);
+    g_test_add_func(TEST_("drain"), test_drain);
+    g_test_add_func(TEST_("opt"), test_opt_limits);
+    test_init(&test_opt, argc, argv);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -42,8 +42,8 @@
 #include "ndef_rec_p.h"
 #include "ndef_tlv.h"
 #include "ndef_util_p.h"
+#include "ndef_log.h"
 
-#include <gutil_log.h>
 #include <gutil_misc.h>
 
 static TestOpt test_opt;
@@ -64,6 +64,66 @@ test_locale(
     GDEBUG("locale = %s", l);
 }
 
+/*==========================================================================*
+ * log_limit
+ *==========================================================================*/
+
+static
+void
+test_log_limit(
+    void)
+{
+    const int saved_level = NDEF_LOG_MODULE.level;
+    NdefLogLimiter limiter;
+    guint saved_interval, saved_burst, interval, burst, i, n;
+
+    ndef_log_get_limit(&saved_interval, &saved_burst);
+    ndef_log_get_limit(NULL, NULL);
+
+    memset(&limiter, 0, sizeof(limiter));
+    limiter.what = "test";
+
+    /* Nothing gets through if warnings are disabled */
+    NDEF_LOG_MODULE.level = GLOG_LEVEL_ERR;
+    g_assert(!ndef_log_limit_check(&limiter));
+
+    /* Only the burst gets through */
+    NDEF_LOG_MODULE.level = GLOG_LEVEL_WARN;
+    ndef_log_set_limit(1000000, 3);
+    ndef_log_get_limit(&interval, &burst);
+    g_assert_cmpuint(interval, == ,1000000);
+    g_assert_cmpuint(burst, == ,3);
+    for (i = 0, n = 0; i < 10; i++) {
+        if (ndef_log_limit_check(&limiter)) {
+            n++;
+        }
+    }
+    g_assert_cmpuint(n, == ,3);
+    g_assert_cmpuint(limiter.suppressed, == ,7);
+
+    /* The next interval reports (and resets) the suppressed count */
+    limiter.start -= (gint64) interval * 1000;
+    g_assert(ndef_log_limit_check(&limiter));
+    g_assert_cmpuint(limiter.suppressed, == ,0);
+    g_assert_cmpuint(limiter.count, == ,1);
+
+    /* Debug level turns rate limiting off */
+    NDEF_LOG_MODULE.level = GLOG_LEVEL_DEBUG;
+    for (i = 0; i < 10; i++) {
+        g_assert(ndef_log_limit_check(&limiter));
+    }
+
+    /* So does zero interval */
+    NDEF_LOG_MODULE.level = GLOG_LEVEL_WARN;
+    ndef_log_set_limit(0, 3);
+    for (i = 0; i < 10; i++) {
+        g_assert(ndef_log_limit_check(&limiter));
+    }
+
+    ndef_log_set_limit(saved_interval, saved_burst);
+    NDEF_LOG_MODULE.level = saved_level;
+}
+
 /*==========================================================================*
  * type
  *==========================================================================*/
@@ -212,6 +272,196 @@ test_chunked(
     g_assert(!ndef_rec_new(&bytes));
 }
 
+/*==========================================================================*
+ * limits
+ *==========================================================================*/
+
+static
+void
+test_limits(
+    void)
+{
+    static const guint8 data[] = {
+        0x91, 0x01, 0x00, 'x',  /* MB,SR,TNF=0x01, type 'x' */
+        0x11, 0x01, 0x00, 'x',  /* SR,TNF=0x01, type 'x' */
+        0x51, 0x01, 0x00, 'x'   /* ME,SR,TNF=0x01, type 'x' */
+    };
+    static const guint8 tlv[] = {
+        TLV_NDEF_MESSAGE, sizeof(data),
+        0x91, 0x01, 0x00, 'x', 0x11, 0x01, 0x00, 'x', 0x51, 0x01, 0x00, 'x',
+        TLV_NDEF_MESSAGE, sizeof(data),
+        0x91, 0x01, 0x00, 'x', 0x11, 0x01, 0x00, 'x', 0x51, 0x01, 0x00, 'x',
+        TLV_TERMINATOR
+    };
+    NDEF_PARSE_RESULT result;
+    NdefParseOpt opt;
+    GUtilData bytes;
+    NdefRec* rec;
+    guint n;
+
+    /* NULL tolerance */
+    g_assert(!ndef_rec_new_opt(NULL, NULL, &result));
+    g_assert_cmpint(result, == ,NDEF_PARSE_ERROR);
+    g_assert(!ndef_rec_new_from_tlv_opt(NULL, NULL, &result));
+    g_assert_cmpint(result, == ,NDEF_PARSE_ERROR);
+
+    /* No limits */
+    memset(&opt, 0, sizeof(opt));
+    TEST_BYTES_SET(bytes, data);
+    rec = ndef_rec_new_opt(&bytes, &opt, &result);
+    g_assert_cmpint(result, == ,NDEF_PARSE_OK);
+    g_assert(rec);
+    g_assert(rec->next);
+    g_assert(rec->next->next);
+    g_assert(!rec->next->next->next);
+    ndef_rec_unref(rec);
+
+    /* Records */
+    opt.max_records = 2;
+    g_assert(!ndef_rec_new_opt(&bytes, &opt, &result));
+    g_assert_cmpint(result, == ,NDEF_PARSE_LIMIT_RECORDS);
+    opt.max_records = 3;
+    rec = ndef_rec_new_opt(&bytes, &opt, NULL);
+    g_assert(rec);
+    ndef_rec_unref(rec);
+
+    /* The limit applies to the whole TLV sequence */
+    TEST_BYTES_SET(bytes, tlv);
+    g_assert(!ndef_rec_new_from_tlv_opt(&bytes, &opt, &result));
+    g_assert_cmpint(result, == ,NDEF_PARSE_LIMIT_RECORDS);
+    opt.max_records = 6;
+    rec = ndef_rec_new_from_tlv_opt(&bytes, &opt, &result);
+    g_assert_cmpint(result, == ,NDEF_PARSE_OK);
+    for (n = 0; rec; n++) {
+        NdefRec* next = ndef_rec_ref(rec->next);
+
+        ndef_rec_unref(rec);
+        rec = next;
+    }
+    g_assert_cmpuint(n, == ,6);
+
+    /* Bytes */
+    memset(&opt, 0, sizeof(opt));
+    opt.max_bytes = 1;
+    TEST_BYTES_SET(bytes, data);
+    g_assert(!ndef_rec_new_opt(&bytes, &opt, &result));
+    g_assert_cmpint(result, == ,NDEF_PARSE_LIMIT_BYTES);
+
+    /* Time (more than enough) */
+    memset(&opt, 0, sizeof(opt));
+    opt.max_time_ms = 60000;
+    rec = ndef_rec_new_opt(&bytes, &opt, &result);
+    g_assert_cmpint(result, == ,NDEF_PARSE_OK);
+    g_assert(rec);
+    ndef_rec_unref(rec);
+}
+
+/*==========================================================================*
+ * filter
+ *==========================================================================*/
+
+static
+guint
+test_filter_count(
+    const GUtilData* block,
+    const NdefRecFilter* filter,
+    NdefRec** first)
+{
+    NdefRec* rec = ndef_rec_new_filtered(block, filter);
+    NdefRec* ptr;
+    guint n = 0;
+
+    for (ptr = rec; ptr; ptr = ptr->next) {
+        n++;
+    }
+    if (first) {
+        *first = rec;
+    } else {
+        ndef_rec_unref(rec);
+    }
+    return n;
+}
+
+static
+void
+test_filter(
+    void)
+{
+    static const guint8 data[] = {
+        0x91, 0x01, 0x02, 'U', 0x00, 'x',
+        0x12, 0x20, 0x01,
+        'a', 'p', 'p', 'l', 'i', 'c', 'a', 't', 'i', 'o', 'n', '/',
+        'v', 'n', 'd', '.', 'b', 'l', 'u', 'e', 't', 'o', 'o', 't', 'h',
+        '.', 'e', 'p', '.', 'o', 'o', 'b', 0x00,
+        0x12, 0x09, 0x01,
+        'I', 'm', 'a', 'g', 'e', '/', 'p', 'n', 'g', 0x00,
+        0x14, 0x03, 0x00, 'a', ':', 'b',
+        0x51, 0x01, 0x02, 'U', 0x00, 'y'
+    };
+    static const guint8 ext_type[] = { 'a', ':', 'b' };
+    static const guint8 u_type[] = { 'U' };
+    GUtilData types[2];
+    NdefRecFilter filter;
+    GUtilData block;
+    NdefRec* rec;
+
+    /* NULL tolerance */
+    memset(&filter, 0, sizeof(filter));
+    g_assert(!ndef_rec_new_filtered(NULL, &filter));
+
+    /* NULL or empty filter lets everything through */
+    TEST_BYTES_SET(block, data);
+    g_assert_cmpuint(test_filter_count(&block, NULL, NULL), == ,5);
+    g_assert_cmpuint(test_filter_count(&block, &filter, NULL), == ,5);
+
+    /* The first URI */
+    filter.tnf_mask = NDEF_TNF_BIT(NDEF_TNF_WELL_KNOWN);
+    g_assert_cmpuint(test_filter_count(&block, &filter, NULL), == ,2);
+    filter.max_matches = 1;
+    g_assert_cmpuint(test_filter_count(&block, &filter, &rec), == ,1);
+    g_assert(NDEF_IS_REC_U(rec));
+    g_assert_cmpstr(NDEF_REC_U(rec)->uri, == ,"x");
+    ndef_rec_unref(rec);
+
+    /* Media types */
+    memset(&filter, 0, sizeof(filter));
+    filter.media_type = "application/vnd.bluetooth.ep.oob";
+    g_assert_cmpuint(test_filter_count(&block, &filter, &rec), == ,1);
+    g_assert_cmpint(rec->tnf, == ,NDEF_TNF_MEDIA_TYPE);
+    g_assert_cmpuint(rec->payload.size, == ,1);
+    ndef_rec_unref(rec);
+    filter.media_type = "image/*";
+    g_assert_cmpuint(test_filter_count(&block, &filter, &rec), == ,1);
+    g_assert_cmpuint(rec->type.size, == ,9);
+    ndef_rec_unref(rec);
+    filter.media_type = "IMAGE/PNG";
+    g_assert_cmpuint(test_filter_count(&block, &filter, NULL), == ,1);
+    filter.media_type = "*/*";
+    g_assert_cmpuint(test_filter_count(&block, &filter, NULL), == ,2);
+    filter.media_type = "text/*";
+    g_assert_cmpuint(test_filter_count(&block, &filter, NULL), == ,0);
+    filter.media_type = "image/jpeg";
+    g_assert_cmpuint(test_filter_count(&block, &filter, NULL), == ,0);
+    filter.media_type = "image";
+    g_assert_cmpuint(test_filter_count(&block, &filter, NULL), == ,0);
+
+    /* Types */
+    memset(&filter, 0, sizeof(filter));
+    TEST_BYTES_SET(types[0], ext_type);
+    TEST_BYTES_SET(types[1], u_type);
+    filter.types = types;
+    filter.ntypes = 1;
+    g_assert_cmpuint(test_filter_count(&block, &filter, &rec), == ,1);
+    g_assert_cmpint(rec->tnf, == ,NDEF_TNF_EXTERNAL);
+    ndef_rec_unref(rec);
+    filter.ntypes = 2;
+    g_assert_cmpuint(test_filter_count(&block, &filter, NULL), == ,3);
+    filter.tnf_mask = NDEF_TNF_BIT(NDEF_TNF_EXTERNAL);
+    g_assert_cmpuint(test_filter_count(&block, &filter, NULL), == ,1);
+    filter.tnf_mask = NDEF_TNF_BIT(NDEF_TNF_ABSOLUTE_URI);
+    g_assert_cmpuint(test_filter_count(&block, &filter, NULL), == ,0);
+}
+
 /*==========================================================================*
  * tlv
  *==========================================================================*/
@@ -599,6 +849,7 @@ test_mediatype(
     void)
 {
     NdefRec* rec;
+    GBytes* bytes;
     GUtilData type, data;
     static const guint8 png[] = {
         0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a,
@@ -660,6 +911,33 @@ test_mediatype(
     g_assert_cmpuint(rec->raw.size, == ,sizeof(ndef_png));
     g_assert(!memcmp(rec->raw.bytes, ndef_png, rec->raw.size));
     ndef_rec_unref(rec);
+
+    /* Same thing with the payload ownership transfer */
+    rec = ndef_rec_new_mediatype_take(&type, g_bytes_new(png, sizeof(png)));
+    g_assert(rec);
+    g_assert_cmpuint(rec->raw.size, == ,sizeof(ndef_png));
+    g_assert(!memcmp(rec->raw.bytes, ndef_png, rec->raw.size));
+    ndef_rec_unref(rec);
+
+    /* The caller keeps its own reference */
+    bytes = g_bytes_new_static(png, sizeof(png));
+    rec = ndef_rec_new_mediatype_take(&type, g_bytes_ref(bytes));
+    g_assert(rec);
+    g_assert_cmpuint(rec->raw.size, == ,sizeof(ndef_png));
+    g_assert(!memcmp(rec->raw.bytes, ndef_png, rec->raw.size));
+    g_assert(!memcmp(g_bytes_get_data(bytes, NULL), png, sizeof(png)));
+    ndef_rec_unref(rec);
+
+    /* Invalid type, the payload is released anyway */
+    g_assert(!ndef_rec_new_mediatype_take(NULL, g_bytes_ref(bytes)));
+    g_bytes_unref(bytes);
+
+    gutil_data_from_string(&type, "application/octet-stream");
+    rec = ndef_rec_new_mediatype_take(&type, NULL);
+    g_assert(rec);
+    g_assert_cmpuint(rec->raw.size, == ,sizeof(ndef_no_data));
+    g_assert(!memcmp(rec->raw.bytes, ndef_no_data, rec->raw.size));
+    ndef_rec_unref(rec);
 }
 
 /*==========================================================================*
@@ -812,6 +1090,239 @@ test_invalid_tnf(
     ndef_rec_unref(rec);
 }
 
+/*==========================================================================*
+ * slab
+ *==========================================================================*/
+
+static
+void
+test_slab(
+    void)
+{
+    static const guint8 data[] = {
+        0x92, 0x03, 0x01, 'a', '/', 'b', 'x',  /* MB, SR, TNF=0x02 */
+        0x11, 0x01, 0x02, 'U', 0x00, 'y',      /* SR, TNF=0x01 */
+        0x52, 0x03, 0x01, 'a', '/', 'b', 'z'   /* ME, SR, TNF=0x02 */
+    };
+    NDEF_PARSE_RESULT result;
+    NdefParseOpt opt;
+    NdefRec* rec;
+    NdefRec* uri;
+    NdefRec* last;
+    GUtilData bytes;
+
+    /* Records aren't packed by default */
+    TEST_BYTES_SET(bytes, data);
+    rec = ndef_rec_new(&bytes);
+    g_assert(rec);
+    uri = rec->next;
+    g_assert(uri);
+    g_assert(uri->raw.bytes != rec->raw.bytes + rec->raw.size);
+    ndef_rec_unref(rec);
+
+    memset(&opt, 0, sizeof(opt));
+    opt.flags = NDEF_PARSE_FLAG_PACKED;
+    rec = ndef_rec_new_opt(&bytes, &opt, &result);
+    g_assert_cmpint(result, == ,NDEF_PARSE_OK);
+    g_assert(rec);
+    uri = rec->next;
+    g_assert(NDEF_IS_REC_U(uri));
+    last = uri->next;
+    g_assert(last);
+    g_assert(!last->next);
+
+    /* Records follow each other, the decoded URI follows its record */
+    g_assert(uri->raw.bytes == rec->raw.bytes + rec->raw.size);
+    g_assert(NDEF_REC_U(uri)->uri == (const char*)
+        (uri->raw.bytes + uri->raw.size));
+    g_assert(last->raw.bytes == uri->raw.bytes + uri->raw.size + 2);
+    g_assert(!memcmp(last->raw.bytes, data + 13, 7));
+
+    /* The slab survives the first record */
+    ndef_rec_ref(last);
+    ndef_rec_unref(rec);
+    g_assert(!memcmp(last->raw.bytes, data + 13, 7));
+    g_assert_cmpuint(last->payload.size, == ,1);
+    g_assert_cmpint(last->payload.bytes[0], == ,'z');
+    ndef_rec_unref(last);
+}
+
+/*==========================================================================*
+ * hash
+ *==========================================================================*/
+
+static
+void
+test_hash(
+    void)
+{
+    static const guint8 msg_short[] = {
+        0x92, 0x03, 0x01, 'a', '/', 'b', 'x',    /* MB, SR, TNF=0x02 */
+        0x52, 0x03, 0x01, 'a', '/', 'b', 'z'     /* ME, SR, TNF=0x02 */
+    };
+    static const guint8 msg_long[] = {
+        0x82, 0x03, 0x00, 0x00, 0x00, 0x01,      /* MB, TNF=0x02 */
+        'a', '/', 'b', 'x',
+        0x42, 0x03, 0x00, 0x00, 0x00, 0x01,      /* ME, TNF=0x02 */
+        'a', '/', 'b', 'z'
+    };
+    static const guint8 single[] = {
+        0xd2, 0x03, 0x01, 'a', '/', 'b', 'x'     /* MB, ME, SR, TNF=0x02 */
+    };
+    static const guint8 empty[] = {
+        0xd0, 0x00, 0x00                         /* MB, ME, SR, TNF=0x00 */
+    };
+    static const guint8 unknown[] = {
+        0xd5, 0x00, 0x00                         /* MB, ME, SR, TNF=0x05 */
+    };
+    GUtilData bytes;
+    GHashTable* table;
+    NdefRec* m1;
+    NdefRec* m2;
+    NdefRec* r1;
+    NdefRec* r2;
+    NdefRec* r3;
+
+    TEST_BYTES_SET(bytes, msg_short);
+    g_assert((m1 = ndef_rec_new(&bytes)) != NULL);
+    TEST_BYTES_SET(bytes, msg_long);
+    g_assert((m2 = ndef_rec_new(&bytes)) != NULL);
+    TEST_BYTES_SET(bytes, single);
+    g_assert((r1 = ndef_rec_new(&bytes)) != NULL);
+    TEST_BYTES_SET(bytes, empty);
+    g_assert((r2 = ndef_rec_new(&bytes)) != NULL);
+    TEST_BYTES_SET(bytes, unknown);
+    g_assert((r3 = ndef_rec_new(&bytes)) != NULL);
+
+    /* NULL */
+    g_assert_cmpuint(ndef_rec_hash(NULL), == ,0);
+    g_assert(ndef_rec_equal(NULL, NULL));
+    g_assert(!ndef_rec_equal(r1, NULL));
+    g_assert(!ndef_rec_equal(NULL, r1));
+    g_assert(ndef_rec_msg_equal(NULL, NULL));
+    g_assert(!ndef_rec_msg_equal(m1, NULL));
+    g_assert(ndef_rec_msg_equal(m1, m1));
+
+    /* Header encoding and flags don't matter */
+    g_assert(ndef_rec_equal(m1, m2));
+    g_assert(ndef_rec_equal(m1, r1));
+    g_assert(ndef_rec_equal(m1->next, m2->next));
+    g_assert(!ndef_rec_equal(m1, m1->next));
+    g_assert_cmpuint(ndef_rec_hash(m1), == ,ndef_rec_hash(m2));
+    g_assert_cmpuint(ndef_rec_hash(m1), == ,ndef_rec_hash(r1));
+    g_assert_cmpuint(ndef_rec_hash(m1), != ,ndef_rec_hash(m1->next));
+
+    /* But TNF does */
+    g_assert(!ndef_rec_equal(r2, r3));
+    g_assert_cmpuint(ndef_rec_hash(r2), != ,ndef_rec_hash(r3));
+
+    /* Messages */
+    g_assert(ndef_rec_msg_equal(m1, m2));
+    g_assert(!ndef_rec_msg_equal(m1, r1));
+    g_assert(!ndef_rec_msg_equal(r1, m1));
+    g_assert_cmpuint(ndef_rec_msg_hash(m1), == ,ndef_rec_msg_hash(m2));
+    g_assert_cmpuint(ndef_rec_msg_hash(m1), != ,ndef_rec_msg_hash(r1));
+
+    table = g_hash_table_new(ndef_rec_msg_hash, ndef_rec_msg_equal);
+    g_hash_table_add(table, m1);
+    g_assert(g_hash_table_contains(table, m2));
+    g_assert(!g_hash_table_contains(table, r1));
+    g_hash_table_destroy(table);
+
+    ndef_rec_unref(m1);
+    ndef_rec_unref(m2);
+    ndef_rec_unref(r1);
+    ndef_rec_unref(r2);
+    ndef_rec_unref(r3);
+}
+
+/*==========================================================================*
+ * reparse
+ *==========================================================================*/
+
+static
+void
+test_reparse(
+    void)
+{
+    static const guint8 msg[] = {
+        0x91, 0x01, 0x02, 'U', 0x01, 'x',        /* MB, SR, TNF=0x01 */
+        0x11, 0x01, 0x04, 'T', 0x02, 'e', 'n', 'y',
+        0x11, 0x02, 0x06, 'S', 'p',
+        0xd1, 0x01, 0x02, 'U', 0x01, 's',
+        0x52, 0x03, 0x01, 'a', '/', 'b', 'z'     /* ME, SR, TNF=0x02 */
+    };
+    static const guint8 garbage[] = { 0x00 };
+    guint8 buf[sizeof(msg)];
+    GUtilData bytes;
+    NdefRec* prev;
+    NdefRec* rec;
+    NdefRec* r1;
+    NdefRec* r2;
+
+    g_assert(!ndef_rec_reparse(NULL, NULL));
+    TEST_BYTES_SET(bytes, msg);
+    prev = ndef_rec_reparse(NULL, &bytes);
+    g_assert(prev);
+    g_assert(!ndef_rec_reparse(prev, NULL));
+    TEST_BYTES_SET(bytes, garbage);
+    g_assert(!ndef_rec_reparse(prev, &bytes));
+
+    /* Nothing has changed */
+    memcpy(buf, msg, sizeof(buf));
+    TEST_BYTES_SET(bytes, buf);
+    rec = ndef_rec_reparse(prev, &bytes);
+    g_assert(rec == prev);
+    ndef_rec_unref(rec);
+
+    /* The last record has changed, nothing can be shared */
+    buf[sizeof(buf) - 1] = 'w';
+    rec = ndef_rec_reparse(prev, &bytes);
+    g_assert(rec && rec != prev);
+    for (r1 = prev, r2 = rec; r1 && r2; r1 = r1->next, r2 = r2->next) {
+        g_assert(r1 != r2);
+        g_assert(G_OBJECT_TYPE(r1) == G_OBJECT_TYPE(r2));
+        g_assert(r1->flags == r2->flags);
+        if (r1->next) {
+            g_assert(ndef_rec_equal(r1, r2));
+        } else {
+            g_assert(!ndef_rec_equal(r1, r2));
+        }
+    }
+    g_assert(!r1 && !r2);
+    g_assert_cmpstr(NDEF_REC_U(rec)->uri, == ,"http://www.x");
+    g_assert_cmpstr(NDEF_REC_T(rec->next)->lang, == ,"en");
+    g_assert_cmpstr(NDEF_REC_T(rec->next)->text, == ,"y");
+    g_assert_cmpstr(NDEF_REC_SP(rec->next->next)->uri, == ,"http://www.s");
+    g_assert_cmpint(rec->next->next->next->payload.bytes[0], == ,'w');
+    ndef_rec_unref(rec);
+
+    /* The first record has changed, the rest is shared */
+    memcpy(buf, msg, sizeof(buf));
+    buf[5] = 'y';
+    rec = ndef_rec_reparse(prev, &bytes);
+    g_assert(rec && rec != prev);
+    g_assert(rec->next == prev->next);
+    g_assert_cmpstr(NDEF_REC_U(rec)->uri, == ,"http://www.y");
+    g_assert_cmpstr(NDEF_REC_U(prev)->uri, == ,"http://www.x");
+    ndef_rec_unref(prev);
+    prev = rec;
+
+    /* The last record is gone, nothing is shared but a few are reused */
+    TEST_BYTES_SET(bytes, msg);
+    bytes.size -= 7;
+    rec = ndef_rec_reparse(prev, &bytes);
+    g_assert(rec);
+    g_assert_cmpstr(NDEF_REC_U(rec)->uri, == ,"http://www.x");
+    g_assert(rec->next != prev->next);
+    g_assert(ndef_rec_equal(rec->next, prev->next));
+    g_assert(ndef_rec_equal(rec->next->next, prev->next->next));
+    g_assert(!rec->next->next->next);
+    ndef_rec_unref(rec);
+
+    ndef_rec_unref(prev);
+}
+
 /*==========================================================================*
  * broken1
  *==========================================================================*/
@@ -867,12 +1378,15 @@ int main(int argc, char* argv[])
     G_GNUC_END_IGNORE_DEPRECATIONS;
     g_test_init(&argc, &argv, NULL);
     g_test_add_func(TEST_("locale"), test_locale);
+    g_test_add_func(TEST_("log_limit"), test_log_limit);
     g_test_add_func(TEST_("type"), test_type);
     g_test_add_func(TEST_("payload"), test_payload);
     g_test_add_func(TEST_("null"), test_null);
     g_test_add_func(TEST_("empty"), test_empty);
     g_test_add_func(TEST_("short"), test_short);
     g_test_add_func(TEST_("chunked"), test_chunked);
+    g_test_add_func(TEST_("limits"), test_limits);
+    g_test_add_func(TEST_("filter"), test_filter);
     g_test_add_func(TEST_("tlv"), test_tlv);
     g_test_add_func(TEST_("tlv_empty"), test_tlv_empty);
     g_test_add_func(TEST_("tlv_complex"), test_tlv_complex);
@@ -887,6 +1401,9 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_("id"), test_id);
     g_test_add_func(TEST_("unknown"), test_unknown);
     g_test_add_func(TEST_("invalid_tnf"), test_invalid_tnf);
+    g_test_add_func(TEST_("slab"), test_slab);
+    g_test_add_func(TEST_("hash"), test_hash);
+    g_test_add_func(TEST_("reparse"), test_reparse);
     g_test_add_func(TEST_("broken1"), test_broken1);
     g_test_add_func(TEST_("broken2"), test_broken2);
     test_init(&test_opt, argc, argv);
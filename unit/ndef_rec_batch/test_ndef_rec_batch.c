@@ -0,0 +1,288 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "test_common.h"
+
+#include "ndef_rec.h"
+
+#include <gutil_misc.h>
+
+static TestOpt test_opt;
+
+static const guint8 test_garbage[] = { 0x00 };
+
+/* Stubs */
+
+const char*
+ndef_system_locale(
+    void)
+{
+    return NULL;
+}
+
+/* Utilities */
+
+#define TEST_COUNT (1000)
+
+/* Every third input is broken, the rest are URI records */
+static
+GUtilData*
+test_inputs(
+    gboolean tlv)
+{
+    GUtilData* inputs = g_new(GUtilData, TEST_COUNT);
+    guint i;
+
+    for (i = 0; i < TEST_COUNT; i++) {
+        if (i % 3) {
+            char* suffix = g_strdup_printf("%u", i);
+            const gsize len = strlen(suffix);
+            guint8* data = g_malloc(len + 8);
+            guint8* rec = tlv ? (data + 2) : data;
+
+            rec[0] = 0xd1; /* MB, ME, SR, TNF=0x01 */
+            rec[1] = 0x01;
+            rec[2] = (guint8) (len + 1);
+            rec[3] = 'U';
+            rec[4] = 0x01; /* http://www. */
+            memcpy(rec + 5, suffix, len);
+            if (tlv) {
+                data[0] = 0x03; /* NDEF Message TLV */
+                data[1] = (guint8) (len + 5);
+                data[len + 7] = 0xfe; /* Terminator TLV */
+            }
+            inputs[i].bytes = data;
+            inputs[i].size = len + (tlv ? 8 : 5);
+            g_free(suffix);
+        } else {
+            inputs[i].bytes = gutil_memdup(test_garbage,
+                sizeof(test_garbage));
+            inputs[i].size = sizeof(test_garbage);
+        }
+    }
+    return inputs;
+}
+
+static
+void
+test_inputs_free(
+    GUtilData* inputs)
+{
+    guint i;
+
+    for (i = 0; i < TEST_COUNT; i++) {
+        g_free((gpointer) inputs[i].bytes);
+    }
+    g_free(inputs);
+}
+
+static
+void
+test_check(
+    NdefRec** results,
+    const NDEF_PARSE_RESULT* status)
+{
+    guint i;
+
+    for (i = 0; i < TEST_COUNT; i++) {
+        NdefRec* rec = results[i];
+
+        if (i % 3) {
+            char* uri = g_strdup_printf("http://www.%u", i);
+
+            g_assert(NDEF_IS_REC_U(rec));
+            g_assert(!rec->next);
+            g_assert_cmpstr(NDEF_REC_U(rec)->uri, == ,uri);
+            if (status) {
+                g_assert_cmpint(status[i], == ,NDEF_PARSE_OK);
+            }
+            g_free(uri);
+        } else {
+            g_assert(!rec);
+            if (status) {
+                g_assert_cmpint(status[i], == ,NDEF_PARSE_ERROR);
+            }
+        }
+        ndef_rec_unref(rec);
+    }
+}
+
+/*==========================================================================*
+ * null
+ *==========================================================================*/
+
+static
+void
+test_null(
+    void)
+{
+    GUtilData input;
+    NdefRec* rec = NULL;
+
+    TEST_BYTES_SET(input, test_garbage);
+    g_assert_cmpuint(ndef_rec_new_batch(NULL, 1, FALSE, NULL, 0, &rec,
+        NULL), == ,0);
+    g_assert_cmpuint(ndef_rec_new_batch(&input, 1, FALSE, NULL, 0, NULL,
+        NULL), == ,0);
+    g_assert_cmpuint(ndef_rec_new_batch(&input, 0, FALSE, NULL, 0, &rec,
+        NULL), == ,0);
+
+    /* Too many inputs, none of them is even looked at */
+    g_assert_cmpuint(ndef_rec_new_batch(&input, G_MAXUINT, FALSE, NULL, 0,
+        &rec, NULL), == ,0);
+    g_assert(!rec);
+}
+
+/*==========================================================================*
+ * basic
+ *==========================================================================*/
+
+static
+void
+test_basic(
+    gconstpointer data)
+{
+    const guint threads = GPOINTER_TO_UINT(data);
+    const guint expected = TEST_COUNT - (TEST_COUNT + 2) / 3;
+    GUtilData* inputs = test_inputs(FALSE);
+    NdefRec** results = g_new0(NdefRec*, TEST_COUNT);
+    NDEF_PARSE_RESULT* status = g_new0(NDEF_PARSE_RESULT, TEST_COUNT);
+
+    g_assert_cmpuint(ndef_rec_new_batch(inputs, TEST_COUNT, FALSE, NULL,
+        threads, results, status), == ,expected);
+    test_check(results, status);
+
+    /* Status is optional */
+    g_assert_cmpuint(ndef_rec_new_batch(inputs, TEST_COUNT, FALSE, NULL,
+        threads, results, NULL), == ,expected);
+    test_check(results, NULL);
+
+    g_free(status);
+    g_free(results);
+    test_inputs_free(inputs);
+}
+
+/*==========================================================================*
+ * tlv
+ *==========================================================================*/
+
+static
+void
+test_tlv(
+    void)
+{
+    const guint expected = TEST_COUNT - (TEST_COUNT + 2) / 3;
+    GUtilData* inputs = test_inputs(TRUE);
+    NdefRec** results = g_new0(NdefRec*, TEST_COUNT);
+    NDEF_PARSE_RESULT* status = g_new0(NDEF_PARSE_RESULT, TEST_COUNT);
+
+    g_assert_cmpuint(ndef_rec_new_batch(inputs, TEST_COUNT, TRUE, NULL, 4,
+        results, status), == ,expected);
+    test_check(results, status);
+
+    g_free(status);
+    g_free(results);
+    test_inputs_free(inputs);
+}
+
+/*==========================================================================*
+ * limits
+ *==========================================================================*/
+
+static
+void
+test_limits(
+    void)
+{
+    static const guint8 two_recs[] = {
+        0x91, 0x01, 0x02, 'U', 0x01, 'x',
+        0x51, 0x01, 0x02, 'U', 0x01, 'y'
+    };
+    GUtilData inputs[2];
+    NdefRec* results[2];
+    NDEF_PARSE_RESULT status[2];
+    NdefParseOpt opt;
+
+    memset(&opt, 0, sizeof(opt));
+    opt.max_records = 1;
+    TEST_BYTES_SET(inputs[0], two_recs);
+    inputs[1] = inputs[0];
+    inputs[1].size = 6;
+
+    /* The options apply to each input separately */
+    g_assert_cmpuint(ndef_rec_new_batch(inputs, 2, FALSE, &opt, 2,
+        results, status), == ,1);
+    g_assert(!results[0]);
+    g_assert_cmpint(status[0], == ,NDEF_PARSE_LIMIT_RECORDS);
+    g_assert(NDEF_IS_REC_U(results[1]));
+    g_assert_cmpint(status[1], == ,NDEF_PARSE_OK);
+    ndef_rec_unref(results[1]);
+}
+
+/*==========================================================================*
+ * Common
+ *==========================================================================*/
+
+#define TEST_(name) "/ndef_rec_batch/" name
+
+int main(int argc, char* argv[])
+{
+    G_GNUC_BEGIN_IGNORE_DEPRECATIONS;
+    g_type_init();
+    G_GNUC_END_IGNORE_DEPRECATIONS;
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("null"), test_null);
+    g_test_add_data_func(TEST_("default"), GUINT_TO_POINTER(0),
+        test_basic);
+    g_test_add_data_func(TEST_("single"), GUINT_TO_POINTER(1),
+        test_basic);
+    g_test_add_data_func(TEST_("many"), GUINT_TO_POINTER(16),
+        test_basic);
+    g_test_add_func(TEST_("tlv"), test_tlv);
+    g_test_add_func(TEST_("limits"), test_limits);
+    test_init(&test_opt, argc, argv);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,314 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "test_common.h"
+
+#include "ndef_rec.h"
+
+static TestOpt test_opt;
+
+static const guint8 test_uri_rec[] = {
+    0xd1,           /* NDEF record header (MB=1, ME=1, SR=1, TNF=0x01) */
+    0x01,           /* Length of the record type */
+    0x02,           /* Length of the record payload */
+    'U',            /* Record type: 'U' (URI) */
+    0x01, 'x'       /* http://www.x */
+};
+
+static const guint8 test_uri_rec2[] = {
+    0xd1, 0x01, 0x02, 'U', 0x01, 'y'
+};
+
+static const guint8 test_uri_rec3[] = {
+    0xd1, 0x01, 0x02, 'U', 0x01, 'z'
+};
+
+static const guint8 test_uri_tlv[] = {
+    0x03, 0x06,     /* NDEF Message TLV */
+    0xd1, 0x01, 0x02, 'U', 0x01, 'x',
+    0xfe            /* Terminator TLV */
+};
+
+/* Stubs */
+
+const char*
+ndef_system_locale(
+    void)
+{
+    return NULL;
+}
+
+/* Utilities */
+
+static
+NdefRec*
+test_parse(
+    const void* bytes,
+    gsize size)
+{
+    GUtilData data;
+
+    data.bytes = bytes;
+    data.size = size;
+    return ndef_rec_new(&data);
+}
+
+static
+NdefRec*
+test_parse_tlv(
+    const void* bytes,
+    gsize size)
+{
+    GUtilData data;
+
+    data.bytes = bytes;
+    data.size = size;
+    return ndef_rec_new_from_tlv(&data);
+}
+
+/*==========================================================================*
+ * disabled
+ *==========================================================================*/
+
+static
+void
+test_disabled(
+    void)
+{
+    NdefRec* rec;
+    NdefRec* rec2;
+
+    /* These don't do anything without a cache */
+    ndef_rec_cache_clear();
+    ndef_rec_cache_set_max_size(0);
+
+    g_assert(!ndef_rec_new(NULL));
+    g_assert(!ndef_rec_new_from_tlv(NULL));
+
+    rec = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec));
+    rec2 = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec));
+    g_assert(NDEF_IS_REC_U(rec));
+    g_assert(NDEF_IS_REC_U(rec2));
+    g_assert(rec != rec2);
+    ndef_rec_unref(rec);
+    ndef_rec_unref(rec2);
+}
+
+/*==========================================================================*
+ * hit
+ *==========================================================================*/
+
+static
+void
+test_hit(
+    void)
+{
+    static const guint8 garbage[] = { 0x00 };
+    NdefRec* rec;
+    NdefRec* rec2;
+
+    ndef_rec_cache_set_max_size(10);
+
+    g_assert(!ndef_rec_new(NULL));
+    g_assert(!test_parse(TEST_ARRAY_AND_SIZE(garbage)));
+    g_assert(!test_parse(TEST_ARRAY_AND_SIZE(garbage)));
+
+    rec = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec));
+    g_assert(NDEF_IS_REC_U(rec));
+    ndef_rec_unref(rec);
+
+    /* The same object is returned */
+    rec2 = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec));
+    g_assert(rec2 == rec);
+    g_assert_cmpstr(NDEF_REC_U(rec2)->uri, == ,"http://www.x");
+
+    /* The same message inside TLV is a different key */
+    rec = test_parse_tlv(TEST_ARRAY_AND_SIZE(test_uri_tlv));
+    g_assert(NDEF_IS_REC_U(rec));
+    g_assert(rec != rec2);
+    g_assert(ndef_rec_msg_equal(rec, rec2));
+    g_assert(test_parse_tlv(TEST_ARRAY_AND_SIZE(test_uri_tlv)) == rec);
+    ndef_rec_unref(rec);
+    ndef_rec_unref(rec);
+
+    /* Different content */
+    rec = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec2));
+    g_assert(rec != rec2);
+    g_assert_cmpstr(NDEF_REC_U(rec)->uri, == ,"http://www.y");
+    ndef_rec_unref(rec);
+    ndef_rec_unref(rec2);
+
+    /* Cleared cache parses again */
+    ndef_rec_cache_clear();
+    rec = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec));
+    g_assert(NDEF_IS_REC_U(rec));
+    ndef_rec_unref(rec);
+
+    ndef_rec_cache_set_max_size(0);
+}
+
+/*==========================================================================*
+ * lru
+ *==========================================================================*/
+
+static
+void
+test_lru(
+    void)
+{
+    NdefRec* r1;
+    NdefRec* r2;
+    NdefRec* r3;
+    NdefRec* rec;
+
+    ndef_rec_cache_set_max_size(2);
+
+    r1 = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec));
+    r2 = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec2));
+
+    /* Touch r1, so that r2 becomes the least recently used one */
+    rec = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec));
+    g_assert(rec == r1);
+    ndef_rec_unref(rec);
+
+    /* This evicts r2 */
+    r3 = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec3));
+    rec = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec));
+    g_assert(rec == r1);
+    ndef_rec_unref(rec);
+    rec = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec3));
+    g_assert(rec == r3);
+    ndef_rec_unref(rec);
+
+    /* Shrinking the cache drops the least recently used entries */
+    ndef_rec_cache_set_max_size(1);
+    rec = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec3));
+    g_assert(rec == r3);
+    ndef_rec_unref(rec);
+    rec = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec));
+    g_assert(rec != r1);
+    ndef_rec_unref(rec);
+    rec = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec2));
+    g_assert(rec != r2);
+    ndef_rec_unref(rec);
+
+    /* The evicted records are still usable */
+    g_assert_cmpstr(NDEF_REC_U(r1)->uri, == ,"http://www.x");
+    g_assert_cmpstr(NDEF_REC_U(r2)->uri, == ,"http://www.y");
+    g_assert_cmpstr(NDEF_REC_U(r3)->uri, == ,"http://www.z");
+    ndef_rec_unref(r1);
+    ndef_rec_unref(r2);
+    ndef_rec_unref(r3);
+
+    ndef_rec_cache_set_max_size(0);
+}
+
+/*==========================================================================*
+ * thread
+ *==========================================================================*/
+
+#define TEST_THREADS (4)
+#define TEST_THREAD_LOOPS (1000)
+
+static
+gpointer
+test_thread_proc(
+    gpointer data)
+{
+    int i;
+
+    for (i = 0; i < TEST_THREAD_LOOPS; i++) {
+        NdefRec* rec = (i & 1) ?
+            test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec)) :
+            test_parse_tlv(TEST_ARRAY_AND_SIZE(test_uri_tlv));
+
+        g_assert(NDEF_IS_REC_U(rec));
+        g_assert_cmpstr(NDEF_REC_U(rec)->uri, == ,"http://www.x");
+        ndef_rec_unref(rec);
+        if (!(i % 100)) {
+            ndef_rec_cache_clear();
+        }
+    }
+    return data;
+}
+
+static
+void
+test_thread(
+    void)
+{
+    GThread* thread[TEST_THREADS];
+    int i;
+
+    ndef_rec_cache_set_max_size(1);
+    for (i = 0; i < TEST_THREADS; i++) {
+        thread[i] = g_thread_new("test", test_thread_proc, NULL);
+    }
+    for (i = 0; i < TEST_THREADS; i++) {
+        g_assert(!g_thread_join(thread[i]));
+    }
+    ndef_rec_cache_set_max_size(0);
+}
+
+/*==========================================================================*
+ * Common
+ *==========================================================================*/
+
+#define TEST_(name) "/ndef_rec_cache/" name
+
+int main(int argc, char* argv[])
+{
+    G_GNUC_BEGIN_IGNORE_DEPRECATIONS;
+    g_type_init();
+    G_GNUC_END_IGNORE_DEPRECATIONS;
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("disabled"), test_disabled);
+    g_test_add_func(TEST_("hit"), test_hit);
+    g_test_add_func(TEST_("lru"), test_lru);
+    g_test_add_func(TEST_("thread"), test_thread);
+    test_init(&test_opt, argc, argv);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "test_common.h"
+
+#include "ndef_rec.h"
+
+static TestOpt test_opt;
+
+static const guint8 test_uri_rec[] = {
+    0xd1,           /* NDEF record header (MB=1, ME=1, SR=1, TNF=0x01) */
+    0x01,           /* Length of the record type */
+    0x02,           /* Length of the record payload */
+    'U',            /* Record type: 'U' (URI) */
+    0x01, 'x'       /* http://www.x */
+};
+
+static const guint8 test_text_rec[] = {
+    0xd1,           /* NDEF record header (MB=1, ME=1, SR=1, TNF=0x01) */
+    0x01,           /* Length of the record type */
+    0x04,           /* Length of the record payload */
+    'T',            /* Record type: 'T' (TEXT) */
+    0x02, 'e', 'n', 'y'
+};
+
+static const guint8 test_sp_rec[] = {
+    0xd1,           /* NDEF record header (MB=1, ME=1, SR=1, TNF=0x01) */
+    0x02,           /* Length of the record type */
+    0x06,           /* Length of the record payload */
+    'S', 'p',       /* Record type: 'Sp' (Smart Poster) */
+    0xd1, 0x01, 0x02, 'U', 0x01, 'x'
+};
+
+static const guint8 test_two_recs[] = {
+    0x91, 0x01, 0x02, 'U', 0x01, 'x',
+    0x51, 0x01, 0x04, 'T', 0x02, 'e', 'n', 'y'
+};
+
+/* Stubs */
+
+const char*
+ndef_system_locale(
+    void)
+{
+    return NULL;
+}
+
+/* Utilities */
+
+static
+NdefRec*
+test_parse(
+    const void* bytes,
+    gsize size)
+{
+    GUtilData data;
+
+    data.bytes = bytes;
+    data.size = size;
+    return ndef_rec_new(&data);
+}
+
+static
+void
+test_destroy_count(
+    gpointer data)
+{
+    (*(int*)data)++;
+}
+
+/*==========================================================================*
+ * disabled
+ *==========================================================================*/
+
+static
+void
+test_disabled(
+    void)
+{
+    NdefRec* rec;
+
+    /* These don't do anything without a pool */
+    ndef_rec_pool_trim();
+    ndef_rec_pool_set_max_size(0);
+
+    rec = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec));
+    g_assert(NDEF_IS_REC_U(rec));
+    ndef_rec_unref(rec);
+}
+
+/*==========================================================================*
+ * reuse
+ *==========================================================================*/
+
+static
+void
+test_reuse(
+    void)
+{
+    const guint8* buf;
+    NDEF_PARSE_RESULT result;
+    NdefParseOpt opt;
+    GUtilData data;
+    NdefRec* rec;
+    NdefRec* rec2;
+
+    ndef_rec_pool_set_max_size(10);
+
+    rec = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec));
+    g_assert(NDEF_IS_REC_U(rec));
+    buf = rec->raw.bytes;
+    ndef_rec_unref(rec);
+
+    /* Same instance comes back, looking like a new one */
+    rec2 = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec));
+    g_assert(rec2 == rec);
+
+    /* And its buffer gets reused */
+    g_assert(rec2->raw.bytes == buf);
+    g_assert(NDEF_IS_REC_U(rec2));
+    g_assert_cmpstr(NDEF_REC_U(rec2)->uri, == ,"http://www.x");
+    g_assert_cmpuint(rec2->raw.size, == ,sizeof(test_uri_rec));
+    g_assert(!memcmp(rec2->raw.bytes, test_uri_rec, rec2->raw.size));
+    ndef_rec_unref(rec2);
+
+    /* Packed records don't use the buffer (but still reuse the object) */
+    memset(&opt, 0, sizeof(opt));
+    opt.flags = NDEF_PARSE_FLAG_PACKED;
+    data.bytes = test_uri_rec;
+    data.size = sizeof(test_uri_rec);
+    rec2 = ndef_rec_new_opt(&data, &opt, &result);
+    g_assert_cmpint(result, == ,NDEF_PARSE_OK);
+    g_assert(rec2 == rec);
+    g_assert(rec2->raw.bytes != buf);
+    g_assert_cmpstr(NDEF_REC_U(rec2)->uri, == ,"http://www.x");
+    ndef_rec_unref(rec2);
+
+    /* The buffer is still there */
+    rec2 = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec));
+    g_assert(rec2 == rec);
+    g_assert(rec2->raw.bytes == buf);
+    ndef_rec_unref(rec2);
+
+    /* Text records don't share the list with URI records */
+    rec = test_parse(TEST_ARRAY_AND_SIZE(test_text_rec));
+    g_assert(rec != rec2);
+    g_assert(NDEF_IS_REC_T(rec));
+    g_assert_cmpstr(NDEF_REC_T(rec)->lang, == ,"en");
+    g_assert_cmpstr(NDEF_REC_T(rec)->text, == ,"y");
+    ndef_rec_unref(rec);
+
+    /* Built records come from the pool too */
+    rec2 = &ndef_rec_t_new("z", "fi")->rec;
+    g_assert(rec2 == rec);
+    g_assert_cmpstr(NDEF_REC_T(rec2)->lang, == ,"fi");
+    g_assert_cmpstr(NDEF_REC_T(rec2)->text, == ,"z");
+    ndef_rec_unref(rec2);
+
+    /* So do Smart Posters */
+    rec = test_parse(TEST_ARRAY_AND_SIZE(test_sp_rec));
+    g_assert(NDEF_IS_REC_SP(rec));
+    ndef_rec_unref(rec);
+    rec2 = test_parse(TEST_ARRAY_AND_SIZE(test_sp_rec));
+    g_assert(rec2 == rec);
+    g_assert(NDEF_IS_REC_SP(rec2));
+    g_assert_cmpstr(NDEF_REC_SP(rec2)->uri, == ,"http://www.x");
+    g_assert(!NDEF_REC_SP(rec2)->title);
+    ndef_rec_unref(rec2);
+
+    /* Only the last reference recycles the record */
+    rec = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec));
+    g_assert(ndef_rec_ref(rec) == rec);
+    ndef_rec_unref(rec);
+    g_assert_cmpstr(NDEF_REC_U(rec)->uri, == ,"http://www.x");
+    rec2 = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec));
+    g_assert(rec2 != rec);
+    ndef_rec_unref(rec2);
+    ndef_rec_unref(rec);
+    rec2 = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec));
+    g_assert(rec2 == rec);
+    ndef_rec_unref(rec2);
+
+    /* The whole chain gets pooled */
+    rec = test_parse(TEST_ARRAY_AND_SIZE(test_two_recs));
+    g_assert(NDEF_IS_REC_U(rec));
+    g_assert(NDEF_IS_REC_T(rec->next));
+    g_assert(rec->flags == NDEF_REC_FLAG_FIRST);
+    g_assert(rec->next->flags == NDEF_REC_FLAG_LAST);
+    ndef_rec_unref(rec);
+
+    ndef_rec_pool_trim();
+    ndef_rec_pool_trim();
+    ndef_rec_pool_set_max_size(0);
+}
+
+/*==========================================================================*
+ * not_pooled
+ *==========================================================================*/
+
+static
+void
+test_not_pooled(
+    void)
+{
+    int destroyed = 0;
+    NdefRec* rec;
+
+    /* Records created without the pool are destroyed */
+    rec = test_parse(TEST_ARRAY_AND_SIZE(test_uri_rec));
+    g_object_set_data_full(G_OBJECT(rec), "x", &destroyed,
+        test_destroy_count);
+    ndef_rec_pool_set_max_size(1);
+    ndef_rec_unref(rec);
+    g_assert_cmpint(destroyed, == ,1);
+
+    /* And the records which don't fit */
+    rec = test_parse(TEST_ARRAY_AND_SIZE(test_two_recs));
+    ndef_rec_unref(rec);
+
+    ndef_rec_pool_set_max_size(0);
+}
+
+/*==========================================================================*
+ * thread
+ *==========================================================================*/
+
+static
+gpointer
+test_thread_proc(
+    gpointer data)
+{
+    ndef_rec_pool_set_max_size(2);
+    ndef_rec_unref(test_parse(TEST_ARRAY_AND_SIZE(test_two_recs)));
+
+    /* The pool is freed when the thread exits */
+    return data;
+}
+
+static
+void
+test_thread(
+    void)
+{
+    GThread* thread = g_thread_new("test", test_thread_proc, NULL);
+
+    g_assert(!g_thread_join(thread));
+}
+
+/*==========================================================================*
+ * Common
+ *==========================================================================*/
+
+#define TEST_(name) "/ndef_rec_pool/" name
+
+int main(int argc, char* argv[])
+{
+    G_GNUC_BEGIN_IGNORE_DEPRECATIONS;
+    g_type_init();
+    G_GNUC_END_IGNORE_DEPRECATIONS;
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("disabled"), test_disabled);
+    g_test_add_func(TEST_("reuse"), test_reuse);
+    g_test_add_func(TEST_("not_pooled"), test_not_pooled);
+    g_test_add_func(TEST_("thread"), test_thread);
+    test_init(&test_opt, argc, argv);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -88,11 +88,14 @@ void
 test_null(
     void)
 {
+    NdefParseCtx ctx;
     NdefData ndef;
 
     memset(&ndef, 0, sizeof(ndef));
-    g_assert(!ndef_rec_sp_new_from_data(NULL));
-    g_assert(!ndef_rec_sp_new_from_data(&ndef));
+    ndef_parse_ctx_init(&ctx, NULL);
+    g_assert(!ndef_rec_sp_new_from_data(NULL, &ctx));
+    g_assert(!ndef_rec_sp_new_from_data(&ndef, &ctx));
+    g_assert(!ndef_rec_sp_new_from_data(&ndef, NULL));
     g_assert(!ndef_rec_sp_new(NULL, NULL, NULL, NULL, 0, 0, NULL));
 }
 
@@ -661,6 +664,8 @@ test_valid_check(
     g_assert_cmpint(sp->act, == ,test->act);
     if (test->icon.data.bytes) {
         g_assert(sp->icon);
+        g_assert_cmpuint(GPOINTER_TO_SIZE(sp->icon) % sizeof(gpointer),
+            == ,0);
         g_assert_cmpstr(sp->icon->type, == ,test->icon.type);
     } else {
         g_assert(!sp->icon);
@@ -673,6 +678,9 @@ test_valid(
     gconstpointer data)
 {
     const TestValidData* test = data;
+    NDEF_PARSE_RESULT result;
+    NdefParseOpt opt;
+    NdefParseCtx ctx;
     NdefData ndef;
     NdefRecSp* sp;
     NdefRec* rec;
@@ -684,7 +692,13 @@ test_valid(
     ndef.type_length = ndef.rec.bytes[1];
 
     test_system_locale = test->locale;
-    sp = ndef_rec_sp_new_from_data(&ndef);
+    ndef_parse_ctx_init(&ctx, NULL);
+    sp = ndef_rec_sp_new_from_data(&ndef, &ctx);
+    test_valid_check(sp, test);
+    ndef_rec_unref(&sp->rec);
+
+    /* Context is optional */
+    sp = ndef_rec_sp_new_from_data(&ndef, NULL);
     test_valid_check(sp, test);
     ndef_rec_unref(&sp->rec);
 
@@ -693,6 +707,18 @@ test_valid(
     g_assert(NDEF_IS_REC_SP(rec));
     test_valid_check(NDEF_REC_SP(rec), test);
     ndef_rec_unref(rec);
+
+    /* SmartPoster content is one level deeper */
+    memset(&opt, 0, sizeof(opt));
+    opt.max_depth = 1;
+    g_assert(!ndef_rec_new_opt(&test->rec, &opt, &result));
+    g_assert_cmpint(result, == ,NDEF_PARSE_LIMIT_DEPTH);
+
+    opt.max_depth = 2;
+    rec = ndef_rec_new_opt(&test->rec, &opt, &result);
+    g_assert_cmpint(result, == ,NDEF_PARSE_OK);
+    g_assert(NDEF_IS_REC_SP(rec));
+    ndef_rec_unref(rec);
 }
 
 static
@@ -774,6 +800,7 @@ test_invalid(
     gconstpointer data)
 {
     const TestInvalidData* test = data;
+    NdefParseCtx ctx;
     NdefData ndef;
     NdefRec* rec;
 
@@ -783,7 +810,8 @@ test_invalid(
     ndef.type_offset = 3;
     ndef.type_length = ndef.rec.bytes[1];
 
-    g_assert(!ndef_rec_sp_new_from_data(&ndef));
+    ndef_parse_ctx_init(&ctx, NULL);
+    g_assert(!ndef_rec_sp_new_from_data(&ndef, &ctx));
 
     /* ndef_rec_new turns it into a generic record */
     rec = ndef_rec_new(&test->rec);
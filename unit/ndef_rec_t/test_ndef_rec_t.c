@@ -43,6 +43,8 @@
 #include "ndef_util.h"
 #include "ndef_rec_p.h"
 
+#include <gutil_misc.h>
+
 static TestOpt test_opt;
 static const char* test_system_locale = NULL;
 
@@ -67,8 +69,8 @@ test_null(
     NdefData ndef;
 
     memset(&ndef, 0, sizeof(ndef));
-    g_assert(!ndef_rec_t_new_from_data(NULL));
-    g_assert(!ndef_rec_t_new_from_data(&ndef));
+    g_assert(!ndef_rec_t_new_from_data(NULL, NULL));
+    g_assert(!ndef_rec_t_new_from_data(&ndef, NULL));
     g_assert(!ndef_rec_t_steal_lang(NULL));
     g_assert(!ndef_rec_t_steal_text(NULL));
 }
@@ -398,7 +400,7 @@ test_empty(
     ndef.type_offset = 3;
     ndef.type_length = 1;
 
-    trec = ndef_rec_t_new_from_data(&ndef);
+    trec = ndef_rec_t_new_from_data(&ndef, NULL);
     g_assert(trec);
     g_assert_cmpstr(trec->lang, == ,"");
     g_assert_cmpstr(trec->text, == ,"");
@@ -482,7 +484,7 @@ test_invalid(
     ndef.type_length = 1;
     ndef.type_offset = payload_offset - ndef.type_length;
 
-    g_assert(!ndef_rec_t_new_from_data(&ndef));
+    g_assert(!ndef_rec_t_new_from_data(&ndef, NULL));
 
     /* It still gets interpreted as a generic record by ndef_rec_new() */
     rec = ndef_rec_new(&test->rec);
@@ -595,6 +597,8 @@ test_utf8(
     NdefData ndef;
     NdefRecT* trec;
     const guint payload_offset = 4;
+    const char* lang;
+    GUtilData tag;
 
     memset(&ndef, 0, sizeof(ndef));
     ndef.rec = *rec;
@@ -602,15 +606,24 @@ test_utf8(
     ndef.type_length = 1;
     ndef.type_offset = payload_offset - ndef.type_length;
 
-    trec = ndef_rec_t_new_from_data(&ndef);
+    trec = ndef_rec_t_new_from_data(&ndef, NULL);
     g_assert(trec);
     g_assert_cmpint(trec->rec.tnf, == ,NDEF_TNF_WELL_KNOWN);
     g_assert_cmpint(trec->rec.rtd, == ,NDEF_RTD_TEXT);
     g_assert_cmpstr(trec->lang, == ,test->lang);
     g_assert_cmpstr(trec->text, == ,test->text);
+
+    /* UTF-8 text is not copied */
+    g_assert(trec->text == (const char*) trec->rec.raw.bytes +
+        trec->rec.raw.size - strlen(test->text));
+
+    /* And the language tag is interned */
+    lang = ndef_intern(gutil_data_from_string(&tag, test->lang));
+    g_assert(trec->lang == lang);
     ndef_rec_unref(&trec->rec);
 
     trec = ndef_rec_t_new(test->text, test->lang);
+    g_assert(trec->lang == lang);
     g_assert(test->rec.size == trec->rec.payload.size + payload_offset);
     g_assert(!memcmp(trec->rec.payload.bytes, rec->bytes + payload_offset,
         rec->size - payload_offset));
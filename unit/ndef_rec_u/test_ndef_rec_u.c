@@ -56,8 +56,8 @@ test_null(
 
     memset(&ndef, 0, sizeof(ndef));
     g_assert(!ndef_rec_u_new(NULL));
-    g_assert(!ndef_rec_u_new_from_data(NULL));
-    g_assert(!ndef_rec_u_new_from_data(&ndef));
+    g_assert(!ndef_rec_u_new_from_data(NULL, NULL));
+    g_assert(!ndef_rec_u_new_from_data(&ndef, NULL));
     g_assert(!ndef_rec_u_steal_uri(NULL));
 }
 
@@ -107,7 +107,7 @@ test_invalid_prefix(
     ndef.payload_length = rec[2];
     ndef.type_offset = 3;
     ndef.type_length = 1;
-    g_assert(!ndef_rec_u_new_from_data(&ndef));
+    g_assert(!ndef_rec_u_new_from_data(&ndef, NULL));
 }
 
 /*==========================================================================*
@@ -136,7 +136,7 @@ test_empty(
     ndef.type_offset = 3;
     ndef.type_length = 1;
 
-    urec = ndef_rec_u_new_from_data(&ndef);
+    urec = ndef_rec_u_new_from_data(&ndef, NULL);
     g_assert(urec);
     g_assert(urec->uri);
     g_assert(!urec->uri[0]);
@@ -200,7 +200,7 @@ test_ok(
     ndef.type_offset = 3;
     ndef.type_length = 1;
 
-    urec = ndef_rec_u_new_from_data(&ndef);
+    urec = ndef_rec_u_new_from_data(&ndef, NULL);
     g_assert(urec);
     g_assert_cmpint(urec->rec.tnf, == ,NDEF_TNF_WELL_KNOWN);
     g_assert_cmpint(urec->rec.rtd, == ,NDEF_RTD_URI);
@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "test_common.h"
+
+#include "ndef_rec.h"
+#include "ndef_util.h"
+
+static TestOpt test_opt;
+
+/*==========================================================================*
+ * null
+ *==========================================================================*/
+
+static
+void
+test_null(
+    void)
+{
+    NdefReject r;
+
+    /* NULL tolerance */
+    g_assert_cmpuint(ndef_reject_get(NULL, 1), == ,0);
+    g_assert_cmpuint(ndef_reject_get(&r, 0), == ,0);
+}
+
+/*==========================================================================*
+ * garbage
+ *==========================================================================*/
+
+static
+void
+test_garbage(
+    void)
+{
+    static const guint8 data[] = {
+        0x91,   /* NDEF record header (MB,SR,TNF=0x01) */
+        0x01,   /* Length of the record type */
+        0x00,   /* Length of the record payload */
+        'x',    /* Record type: 'x' */
+        0x01, 0x02 /* Garbage */
+    };
+    GUtilData bytes;
+    NdefReject r;
+    NdefRec* rec;
+
+    ndef_reject_clear();
+    g_assert_cmpuint(ndef_reject_get(&r, 1), == ,0);
+
+    TEST_BYTES_SET(bytes, data);
+    rec = ndef_rec_new(&bytes);
+    g_assert(rec);
+    g_assert(!rec->next);
+    ndef_rec_unref(rec);
+
+    g_assert_cmpuint(ndef_reject_get(&r, 1), == ,1);
+    g_assert(r.reason);
+    g_assert(r.seq);
+    g_assert_cmpuint(r.size, == ,sizeof(data));
+    g_assert_cmpuint(r.offset, == ,4);
+    g_assert_cmpuint(r.data_offset, == ,0);
+    g_assert_cmpuint(r.data_size, == ,sizeof(data));
+    g_assert(!memcmp(r.data, data, sizeof(data)));
+    ndef_reject_dump();
+}
+
+/*==========================================================================*
+ * chunked
+ *==========================================================================*/
+
+static
+void
+test_chunked(
+    void)
+{
+    static const guint8 data[] = {
+        0xf1,   /* NDEF record header (MB,ME,CF,SR,TNF=0x01) */
+        0x01,   /* Length of the record type */
+        0x00,   /* Length of the record payload */
+        'U'
+    };
+    GUtilData bytes;
+    NdefReject r;
+
+    ndef_reject_clear();
+    TEST_BYTES_SET(bytes, data);
+    g_assert(!ndef_rec_new(&bytes));
+    g_assert_cmpuint(ndef_reject_get(&r, 1), == ,1);
+    g_assert(r.reason);
+    g_assert_cmpuint(r.offset, == ,0);
+    g_assert_cmpuint(r.data_size, == ,sizeof(data));
+}
+
+/*==========================================================================*
+ * text
+ *==========================================================================*/
+
+static
+void
+test_text(
+    void)
+{
+    static const guint8 data[] = {
+        0xd1,           /* NDEF record header (MB,ME,SR,TNF=0x01) */
+        0x01,           /* Length of the record type */
+        0x05,           /* Length of the record payload */
+        'T',            /* Record type: 'T' */
+        0x02,           /* UTF-8, language length 2 */
+        'e', 'n',       /* Language */
+        0xc0, 0xc0      /* Invalid UTF-8 */
+    };
+    GUtilData bytes;
+    NdefReject r;
+    NdefRec* rec;
+
+    ndef_reject_clear();
+    TEST_BYTES_SET(bytes, data);
+    rec = ndef_rec_new(&bytes);
+
+    /* Gets parsed as a generic record */
+    g_assert(rec);
+    g_assert(!NDEF_IS_REC_T(rec));
+    ndef_rec_unref(rec);
+
+    /* The offset is relative to the payload */
+    g_assert_cmpuint(ndef_reject_get(&r, 1), == ,1);
+    g_assert_cmpuint(r.size, == ,5);
+    g_assert_cmpuint(r.offset, == ,3);
+    g_assert_cmpuint(r.data_size, == ,5);
+    g_assert(!memcmp(r.data, data + 4, 5));
+}
+
+/*==========================================================================*
+ * wrap
+ *==========================================================================*/
+
+static
+void
+test_wrap(
+    void)
+{
+    guint8 data[NDEF_REJECT_DATA_MAX * 2];
+    NdefReject r[NDEF_REJECT_MAX];
+    GUtilData bytes;
+    guint i;
+
+    /* Only the first 3 bytes are meaningful */
+    memset(data, 0, sizeof(data));
+    data[0] = 0xd1;     /* NDEF record header (MB,ME,SR,TNF=0x01) */
+    data[1] = 0x01;     /* Length of the record type */
+    data[2] = 0xff;     /* Length of the record payload (too long) */
+
+    ndef_reject_clear();
+    bytes.bytes = data;
+    bytes.size = sizeof(data);
+    for (i = 0; i < NDEF_REJECT_MAX + 2; i++) {
+        data[3] = (guint8)i;
+        g_assert(!ndef_rec_new(&bytes));
+    }
+
+    /* The oldest entries are gone */
+    g_assert_cmpuint(ndef_reject_get(r, G_N_ELEMENTS(r)), == ,NDEF_REJECT_MAX);
+    for (i = 0; i < NDEF_REJECT_MAX; i++) {
+        g_assert_cmpuint(r[i].offset, == ,0);
+        g_assert_cmpuint(r[i].size, == ,sizeof(data));
+        g_assert_cmpuint(r[i].data_size, == ,NDEF_REJECT_DATA_MAX);
+        g_assert_cmpuint(r[i].data[3], == ,i + 2);
+        if (i > 0) {
+            g_assert_cmpuint(r[i].seq, == ,r[i - 1].seq + 1);
+        }
+    }
+
+    /* The most recent ones are returned if the buffer is too small */
+    g_assert_cmpuint(ndef_reject_get(r, 2), == ,2);
+    g_assert_cmpuint(r[0].data[3], == ,NDEF_REJECT_MAX);
+    g_assert_cmpuint(r[1].data[3], == ,NDEF_REJECT_MAX + 1);
+    ndef_reject_dump();
+    ndef_reject_clear();
+    g_assert_cmpuint(ndef_reject_get(r, G_N_ELEMENTS(r)), == ,0);
+}
+
+/*==========================================================================*
+ * Common
+ *==========================================================================*/
+
+#define TEST_(name) "/ndef_reject/" name
+
+int main(int argc, char* argv[])
+{
+    G_GNUC_BEGIN_IGNORE_DEPRECATIONS;
+    g_type_init();
+    G_GNUC_END_IGNORE_DEPRECATIONS;
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("null"), test_null);
+    g_test_add_func(TEST_("garbage"), test_garbage);
+    g_test_add_func(TEST_("chunked"), test_chunked);
+    g_test_add_func(TEST_("text"), test_text);
+    g_test_add_func(TEST_("wrap"), test_wrap);
+    test_init(&test_opt, argc, argv);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,463 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "test_common.h"
+
+#include "ndef_msg.h"
+#include "ndef_rtd.h"
+#include "ndef_util.h"
+
+#include <gutil_misc.h>
+
+static TestOpt test_opt;
+static const char* test_system_locale = NULL;
+
+/* Stubs */
+
+const char*
+ndef_system_locale(
+    void)
+{
+    return test_system_locale;
+}
+
+/* Utilities */
+
+static
+void
+test_bytes_equal(
+    GBytes* bytes,
+    const void* data,
+    gsize size)
+{
+    gsize len;
+    const guint8* ptr = g_bytes_get_data(bytes, &len);
+
+    g_assert_cmpuint(len, == ,size);
+    g_assert(!memcmp(ptr, data, size));
+}
+
+/*==========================================================================*
+ * null
+ *==========================================================================*/
+
+static
+void
+test_null(
+    void)
+{
+    g_assert(!ndef_rtd_uri_decode(NULL));
+    g_assert(!ndef_rtd_uri_encode(NULL));
+    g_assert(!ndef_rtd_text_decode(NULL));
+    g_assert(!ndef_rtd_sp_decode(NULL));
+    g_assert(!ndef_rtd_sp_encode(NULL, NULL, NULL, NULL, 0,
+        NDEF_SP_ACT_DEFAULT, NULL));
+    g_assert_cmpint(ndef_rtd_lang_match(NULL, NULL), == ,
+        NDEF_LANG_MATCH_NONE);
+    g_assert_cmpint(ndef_rtd_lang_match("en", NULL), == ,
+        NDEF_LANG_MATCH_NONE);
+}
+
+/*==========================================================================*
+ * rec
+ *==========================================================================*/
+
+static
+void
+test_rec(
+    void)
+{
+    static const guint8 short_rec[] = {
+        0xd9,                   /* MB,ME,SR,IL,TNF=0x01 */
+        0x01, 0x02, 0x01,       /* Type, payload and id length */
+        'U',                    /* Type */
+        'i',                    /* ID */
+        0x03, 'x'               /* Payload */
+    };
+    static const guint8 empty_rec[] = { 0xd0, 0x00, 0x00 };
+    static const guint8 long_rec_hdr[] = {
+        0xc2,                   /* MB,ME,TNF=0x02 (long record) */
+        0x03,                   /* Type length */
+        0x00, 0x00, 0x01, 0x00, /* Payload length */
+        'a', '/', 'b'           /* Type */
+    };
+    static const guint8 payload_data[] = { 0x03, 'x' };
+    guint8 big[256];
+    GUtilData type, id, payload;
+    GBytes* bytes;
+    gsize size;
+    const guint8* data;
+
+    /* Short record with ID */
+    type.bytes = (const guint8*) "U";
+    type.size = 1;
+    id.bytes = (const guint8*) "i";
+    id.size = 1;
+    TEST_BYTES_SET(payload, payload_data);
+    bytes = ndef_msg_rec_encode(NDEF_HDR_MB | NDEF_HDR_ME |
+        NDEF_TNF_WELL_KNOWN, &type, &id, &payload);
+    test_bytes_equal(bytes, TEST_ARRAY_AND_SIZE(short_rec));
+    g_bytes_unref(bytes);
+
+    /* SR and IL flags coming from the caller are ignored */
+    bytes = ndef_msg_rec_encode(NDEF_HDR_MB | NDEF_HDR_ME | NDEF_HDR_SR |
+        NDEF_HDR_IL | NDEF_TNF_EMPTY, NULL, NULL, NULL);
+    test_bytes_equal(bytes, TEST_ARRAY_AND_SIZE(empty_rec));
+    g_bytes_unref(bytes);
+
+    /* Long record */
+    memset(big, 0x55, sizeof(big));
+    type.bytes = (const guint8*) "a/b";
+    type.size = 3;
+    TEST_BYTES_SET(payload, big);
+    bytes = ndef_msg_rec_encode(NDEF_HDR_MB | NDEF_HDR_ME |
+        NDEF_TNF_MEDIA_TYPE, &type, NULL, &payload);
+    data = g_bytes_get_data(bytes, &size);
+    g_assert_cmpuint(size, == ,sizeof(long_rec_hdr) + sizeof(big));
+    g_assert(!memcmp(data, long_rec_hdr, sizeof(long_rec_hdr)));
+    g_assert(!memcmp(data + sizeof(long_rec_hdr), big, sizeof(big)));
+    g_bytes_unref(bytes);
+
+    /* Type is too long */
+    TEST_BYTES_SET(type, big);
+    g_assert(!ndef_msg_rec_encode(NDEF_TNF_WELL_KNOWN, &type, NULL, NULL));
+}
+
+/*==========================================================================*
+ * uri
+ *==========================================================================*/
+
+static
+void
+test_uri(
+    void)
+{
+    static const guint8 payload_data[] = {
+        0x02, 'e', 'x', 'a', 'm', 'p', 'l', 'e', '.', 'c', 'o', 'm'
+    };
+    static const guint8 bad_prefix[] = { 0x24, 'x' };
+    static const char uri[] = "https://www.example.com";
+    GBytes* bytes = ndef_rtd_uri_encode(uri);
+    GUtilData payload;
+    char* str;
+
+    test_bytes_equal(bytes, TEST_ARRAY_AND_SIZE(payload_data));
+    g_bytes_unref(bytes);
+
+    TEST_BYTES_SET(payload, payload_data);
+    str = ndef_rtd_uri_decode(&payload);
+    g_assert_cmpstr(str, == ,uri);
+    g_free(str);
+
+    TEST_BYTES_SET(payload, bad_prefix);
+    g_assert(!ndef_rtd_uri_decode(&payload));
+    payload.size = 0;
+    g_assert(!ndef_rtd_uri_decode(&payload));
+}
+
+/*==========================================================================*
+ * text
+ *==========================================================================*/
+
+static
+void
+test_text(
+    void)
+{
+    static const guint8 utf8_data[] = {
+        0x02, 'e', 'n', 'H', 'e', 'l', 'l', 'o'
+    };
+    static const guint8 utf16le_data[] = {
+        0x82, 'f', 'i', 0xff, 0xfe, 'H', 0x00, 'i', 0x00
+    };
+    static const guint8 utf16_no_bom[] = {
+        0x80, 'H', 0x00
+    };
+    static const guint8 default_lang_data[] = {
+        0x05, 'f', 'i', '-', 'F', 'I', 'x'
+    };
+    static const guint8 default_data[] = { 0x02, 'e', 'n' };
+    static const guint8 bad_utf8[] = { 0x00, 0xff };
+    static const guint8 bad_lang[] = { 0x05, 'e', 'n' };
+    GUtilData payload;
+    NdefRtdText* text;
+    GBytes* bytes;
+
+    /* UTF-8 */
+    bytes = ndef_rtd_text_encode("Hello", "en", NDEF_REC_T_ENC_UTF8);
+    test_bytes_equal(bytes, TEST_ARRAY_AND_SIZE(utf8_data));
+    g_bytes_unref(bytes);
+
+    TEST_BYTES_SET(payload, utf8_data);
+    text = ndef_rtd_text_decode(&payload);
+    g_assert(text);
+    g_assert_cmpstr(text->lang, == ,"en");
+    g_assert_cmpstr(text->text, == ,"Hello");
+    g_assert_cmpint(text->enc, == ,NDEF_REC_T_ENC_UTF8);
+    g_free(text);
+
+    /* UTF-16 */
+    bytes = ndef_rtd_text_encode("Hi", "fi", NDEF_REC_T_ENC_UTF16LE);
+    test_bytes_equal(bytes, TEST_ARRAY_AND_SIZE(utf16le_data));
+    g_bytes_unref(bytes);
+
+    TEST_BYTES_SET(payload, utf16le_data);
+    text = ndef_rtd_text_decode(&payload);
+    g_assert(text);
+    g_assert_cmpstr(text->lang, == ,"fi");
+    g_assert_cmpstr(text->text, == ,"Hi");
+    g_assert_cmpint(text->enc, == ,NDEF_REC_T_ENC_UTF16LE);
+    g_free(text);
+
+    /* Big-endian is the default */
+    TEST_BYTES_SET(payload, utf16_no_bom);
+    text = ndef_rtd_text_decode(&payload);
+    g_assert(text);
+    g_assert_cmpstr(text->lang, == ,"");
+    g_assert_cmpstr(text->text, == ,"H");
+    g_assert_cmpint(text->enc, == ,NDEF_REC_T_ENC_UTF16BE);
+    g_free(text);
+
+    /* Default language */
+    test_system_locale = "fi_FI.UTF-8";
+    bytes = ndef_rtd_text_encode("x", NULL, NDEF_REC_T_ENC_UTF8);
+    test_bytes_equal(bytes, TEST_ARRAY_AND_SIZE(default_lang_data));
+    g_bytes_unref(bytes);
+    test_system_locale = NULL;
+    bytes = ndef_rtd_text_encode(NULL, NULL, NDEF_REC_T_ENC_UTF8);
+    test_bytes_equal(bytes, TEST_ARRAY_AND_SIZE(default_data));
+    g_bytes_unref(bytes);
+
+    /* Invalid */
+    TEST_BYTES_SET(payload, bad_utf8);
+    g_assert(!ndef_rtd_text_decode(&payload));
+    TEST_BYTES_SET(payload, bad_lang);
+    g_assert(!ndef_rtd_text_decode(&payload));
+}
+
+/*==========================================================================*
+ * lang
+ *==========================================================================*/
+
+static
+void
+test_lang(
+    void)
+{
+    static const NdefLanguage en_us = { "en", "US" };
+    static const NdefLanguage en = { "en", NULL };
+
+    g_assert_cmpint(ndef_rtd_lang_match("en-US", &en_us), == ,
+        NDEF_LANG_MATCH_FULL);
+    g_assert_cmpint(ndef_rtd_lang_match("EN-us", &en_us), == ,
+        NDEF_LANG_MATCH_FULL);
+    g_assert_cmpint(ndef_rtd_lang_match("en", &en_us), == ,
+        NDEF_LANG_MATCH_LANGUAGE);
+    g_assert_cmpint(ndef_rtd_lang_match("en-GB", &en_us), == ,
+        NDEF_LANG_MATCH_LANGUAGE);
+    g_assert_cmpint(ndef_rtd_lang_match("en-US", &en), == ,
+        NDEF_LANG_MATCH_LANGUAGE);
+    g_assert_cmpint(ndef_rtd_lang_match("es-US", &en_us), == ,
+        NDEF_LANG_MATCH_TERRITORY);
+    g_assert_cmpint(ndef_rtd_lang_match("e", &en_us), == ,
+        NDEF_LANG_MATCH_NONE);
+    g_assert_cmpint(ndef_rtd_lang_match("", &en_us), == ,
+        NDEF_LANG_MATCH_NONE);
+}
+
+/*==========================================================================*
+ * sp
+ *==========================================================================*/
+
+static
+void
+test_sp(
+    void)
+{
+    static const guint8 payload_data[] = {
+        0x91, 0x01, 0x02, 'U',  /* MB,SR,TNF=0x01 "U" */
+        0x03, 'x',
+        0x11, 0x01, 0x04, 'T',  /* SR,TNF=0x01 "T" */
+        0x02, 'e', 'n', 'T',
+        0x51, 0x03, 0x01,       /* ME,SR,TNF=0x01 "act" */
+        'a', 'c', 't',
+        0x00
+    };
+    static const guint8 icon_data[] = { 0x01, 0x02, 0x03 };
+    NdefMedia icon;
+    GUtilData payload;
+    NdefRtdSp* sp;
+    GBytes* bytes;
+
+    /* Encode */
+    bytes = ndef_rtd_sp_encode("http://x", "T", "en", NULL, 0,
+        NDEF_SP_ACT_OPEN, NULL);
+    test_bytes_equal(bytes, TEST_ARRAY_AND_SIZE(payload_data));
+    g_bytes_unref(bytes);
+
+    /* Decode */
+    TEST_BYTES_SET(payload, payload_data);
+    sp = ndef_rtd_sp_decode(&payload);
+    g_assert(sp);
+    g_assert_cmpstr(sp->uri, == ,"http://x");
+    g_assert_cmpstr(sp->title, == ,"T");
+    g_assert_cmpstr(sp->lang, == ,"en");
+    g_assert(!sp->type);
+    g_assert(!sp->icon);
+    g_assert_cmpuint(sp->size, == ,0);
+    g_assert_cmpint(sp->act, == ,NDEF_SP_ACT_OPEN);
+    g_free(sp);
+
+    /* Round trip */
+    memset(&icon, 0, sizeof(icon));
+    icon.type = "image/png";
+    TEST_BYTES_SET(icon.data, icon_data);
+    bytes = ndef_rtd_sp_encode("http://x", NULL, NULL, "text/html", 1234,
+        NDEF_SP_ACT_DEFAULT, &icon);
+    sp = ndef_rtd_sp_decode(gutil_data_from_bytes(&payload, bytes));
+    g_assert(sp);
+    g_assert_cmpstr(sp->uri, == ,"http://x");
+    g_assert(!sp->title);
+    g_assert(!sp->lang);
+    g_assert_cmpstr(sp->type, == ,"text/html");
+    g_assert_cmpuint(sp->size, == ,1234);
+    g_assert_cmpint(sp->act, == ,NDEF_SP_ACT_DEFAULT);
+    g_assert(sp->icon);
+    g_assert_cmpstr(sp->icon->type, == ,"image/png");
+    g_assert_cmpuint(sp->icon->data.size, == ,sizeof(icon_data));
+    g_assert(!memcmp(sp->icon->data.bytes, icon_data, sizeof(icon_data)));
+    g_bytes_unref(bytes);
+    g_free(sp);
+}
+
+static
+void
+test_sp_title(
+    void)
+{
+    static const guint8 payload_data[] = {
+        0x91, 0x01, 0x02, 'U',  /* MB,SR,TNF=0x01 "U" */
+        0x03, 'x',
+        0x11, 0x01, 0x04, 'T',  /* SR,TNF=0x01 "T" */
+        0x02, 'e', 'n', 'A',
+        0x51, 0x01, 0x07, 'T',  /* ME,SR,TNF=0x01 "T" */
+        0x05, 'd', 'e', '-', 'D', 'E', 'B'
+    };
+    GUtilData payload;
+    NdefRtdSp* sp;
+
+    TEST_BYTES_SET(payload, payload_data);
+
+    /* No system language, the first title wins */
+    test_system_locale = NULL;
+    sp = ndef_rtd_sp_decode(&payload);
+    g_assert(sp);
+    g_assert_cmpstr(sp->title, == ,"A");
+    g_assert_cmpstr(sp->lang, == ,"en");
+    g_free(sp);
+
+    /* The best match */
+    test_system_locale = "de_DE.UTF-8";
+    sp = ndef_rtd_sp_decode(&payload);
+    g_assert(sp);
+    g_assert_cmpstr(sp->title, == ,"B");
+    g_assert_cmpstr(sp->lang, == ,"de-DE");
+    g_free(sp);
+    test_system_locale = NULL;
+}
+
+static
+void
+test_sp_invalid(
+    void)
+{
+    static const guint8 two_uris[] = {
+        0x91, 0x01, 0x02, 'U', 0x03, 'x',
+        0x51, 0x01, 0x02, 'U', 0x03, 'y'
+    };
+    static const guint8 no_uri[] = {
+        0xd1, 0x01, 0x04, 'T', 0x02, 'e', 'n', 'A'
+    };
+    static const guint8 garbage[] = {
+        0x91, 0x01, 0x02, 'U', 0x03, 'x',
+        0x51
+    };
+    GUtilData payload;
+    NdefRtdSp* sp;
+
+    TEST_BYTES_SET(payload, two_uris);
+    g_assert(!ndef_rtd_sp_decode(&payload));
+    TEST_BYTES_SET(payload, no_uri);
+    g_assert(!ndef_rtd_sp_decode(&payload));
+
+    /* Garbage at the end doesn't hurt */
+    TEST_BYTES_SET(payload, garbage);
+    sp = ndef_rtd_sp_decode(&payload);
+    g_assert(sp);
+    g_assert_cmpstr(sp->uri, == ,"http://x");
+    g_free(sp);
+}
+
+/*==========================================================================*
+ * Common
+ *==========================================================================*/
+
+#define TEST_(name) "/ndef_rtd/" name
+
+int main(int argc, char* argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("null"), test_null);
+    g_test_add_func(TEST_("rec"), test_rec);
+    g_test_add_func(TEST_("uri"), test_uri);
+    g_test_add_func(TEST_("text"), test_text);
+    g_test_add_func(TEST_("lang"), test_lang);
+    g_test_add_func(TEST_("sp"), test_sp);
+    g_test_add_func(TEST_("sp_title"), test_sp_title);
+    g_test_add_func(TEST_("sp_invalid"), test_sp_invalid);
+    test_init(&test_opt, argc, argv);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */